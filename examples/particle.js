@@ -13,6 +13,7 @@ var moveParticles = true;
 var drawMethod = 1;
 var lastParticle;
 var mouse = new Vec2();
+var cmd = new gl.CommandBuffer();
 var mouseActive = true;
 var vertSync = gl.isVerticalSyncEnabled();
 
@@ -114,15 +115,17 @@ var loop = function(timePassed, mx, my){
       particle.ry += 0.5;
       particle.rz += 0.6;
       
-      gl.pushMatrices();
-      gl.enableDepthRead();
-      gl.translate(particle.x, particle.y);
-      gl.rotate(particle.rx, particle.ry, particle.rz);
-      gl.drawCube(0, 0, 0, particle.radius, particle.radius, particle.radius);
-      gl.disableDepthRead();
-      gl.popMatrices();
+      // Recorded into the command buffer, executed with one native call below
+      cmd.pushMatrices();
+      cmd.enableDepthRead();
+      cmd.translate(particle.x, particle.y);
+      cmd.rotate(particle.rx, particle.ry, particle.rz);
+      cmd.drawCube(0, 0, 0, particle.radius, particle.radius, particle.radius);
+      cmd.disableDepthRead();
+      cmd.popMatrices();
     }
   }
+  cmd.flush();
   
   gl.disable(gl.LIGHT0);
   gl.disable(gl.LIGHTING);
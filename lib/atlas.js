@@ -0,0 +1,114 @@
+//
+// Atlas
+var self = this;
+
+/**
+ * Packs images into pages of one texture array, so sprites from different images
+ * can be drawn with a single texture bind.
+ * pageSize (default 2048) is the width and height of each page.
+ */
+var Atlas = function Atlas( pageSize ) {
+  if(!(this instanceof Atlas)){
+    return new Atlas(pageSize);
+  }
+  
+  this._handle = __handle__();
+  self.atlas.create(this._handle, pageSize);
+  
+  this.sprites = {};
+};
+
+module.exports = Atlas;
+
+/**
+ * Adds an image (asset path) and returns its sprite
+ * {page, x, y, width, height, u0, v0, u1, v1}, also kept as atlas.sprites[name].
+ */
+Atlas.prototype.add = function( name, path ){
+  var sprite = self.atlas.add(this._handle, path);
+  this.sprites[name] = sprite;
+  return sprite;
+};
+
+/**
+ * Uploads the pages, call after adding images and before drawing.
+ */
+Atlas.prototype.build = function(){
+  self.atlas.build(this._handle);
+  return this;
+};
+
+Atlas.prototype.destroy = function(){
+  self.atlas.destroy(this._handle);
+  this._handle = null;
+  this.sprites = null;
+};
+
+//
+// SpriteBatch
+var FLOATS_PER_SPRITE = 13;
+
+/**
+ * Collects up to capacity sprites from one atlas and draws them in one instanced draw call.
+ */
+var SpriteBatch = function SpriteBatch( atlas, capacity ) {
+  if(!(this instanceof SpriteBatch)){
+    return new SpriteBatch(atlas, capacity);
+  }
+  
+  this._handle = __handle__();
+  self.atlas.createSpriteBatch(this._handle, capacity);
+  
+  this.atlas = atlas;
+  this.capacity = capacity;
+  this.count = 0;
+  this._data = new Float32Array(capacity * FLOATS_PER_SPRITE);
+};
+
+Atlas.SpriteBatch = SpriteBatch;
+
+/**
+ * Queues a sprite at x, y. Width and height default to the sprite size,
+ * the color (r, g, b, a) tints the sprite and defaults to white.
+ */
+SpriteBatch.prototype.add = function( sprite, x, y, w, h, r, g, b, a ){
+  if(this.count >= this.capacity){
+    throw new RangeError('SpriteBatch is full');
+  }
+  
+  var data = this._data;
+  var i = this.count * FLOATS_PER_SPRITE;
+  
+  data[i] = x;
+  data[i + 1] = y;
+  data[i + 2] = w === undefined ? sprite.width : w;
+  data[i + 3] = h === undefined ? sprite.height : h;
+  data[i + 4] = sprite.u0;
+  data[i + 5] = sprite.v0;
+  data[i + 6] = sprite.u1;
+  data[i + 7] = sprite.v1;
+  data[i + 8] = r === undefined ? 1 : r;
+  data[i + 9] = g === undefined ? 1 : g;
+  data[i + 10] = b === undefined ? 1 : b;
+  data[i + 11] = a === undefined ? 1 : a;
+  data[i + 12] = sprite.page;
+  
+  this.count++;
+  return this;
+};
+
+SpriteBatch.prototype.clear = function(){
+  this.count = 0;
+  return this;
+};
+
+SpriteBatch.prototype.draw = function(){
+  self.atlas.drawSprites(this._handle, this.atlas._handle, this._data, this.count);
+  return this;
+};
+
+SpriteBatch.prototype.destroy = function(){
+  self.atlas.destroySpriteBatch(this._handle);
+  this._handle = null;
+  this._data = null;
+};
@@ -2,14 +2,37 @@
 // Batch
 var self = this;
 
-var Batch = function Batch(geomMesh, glslProg) {
+/**
+ * instanceAttribs (optional): [{ vbo: Vbo, name: 'iPosition', dims: 3, stride: 0, offset: 0, divisor: 1 }, ...]
+ * Each Vbo is bound as a per-instance vertex attribute, for use with drawInstanced().
+ */
+var Batch = function Batch(geomMesh, glslProg, instanceAttribs) {
   this._handle = {};
 
   if(!glslProg.isShader){
     throw new TypeError('Need GlslProg shader to create a batch.');
   }
 
-  self.batch.create(this._handle, geomMesh, glslProg.id);
+  if(instanceAttribs){
+    var attribs = [];
+    for(var i = 0; i < instanceAttribs.length; i++){
+      var attrib = instanceAttribs[i];
+      if(!attrib.vbo || !attrib.vbo.isVbo){
+        throw new TypeError('Need a Vbo for instance attribute ' + attrib.name);
+      }
+      attribs.push({
+        vbo: attrib.vbo._handle,
+        name: attrib.name,
+        dims: attrib.dims || 4,
+        stride: attrib.stride || 0,
+        offset: attrib.offset || 0,
+        divisor: attrib.divisor === undefined ? 1 : attrib.divisor
+      });
+    }
+    self.batch.create(this._handle, geomMesh, glslProg.id, attribs);
+  } else {
+    self.batch.create(this._handle, geomMesh, glslProg.id);
+  }
 }
 
 // Convinience flag for type checking
@@ -32,6 +55,10 @@ Batch.prototype.draw = function(){
   self.batch.draw(this._handle.id);
 }
 
+Batch.prototype.drawInstanced = function( count ){
+  self.batch.drawInstanced(this._handle.id, count);
+}
+
 //
 // VertBatch
 
@@ -4,7 +4,7 @@ var Ray = require('ray');
 var self = this;
 
 var Camera = function Camera(){
-  this._handle = {};
+  this._handle = __handle__();
   if(arguments.length == 0){
     self.camera.create(this._handle);
   } else if(arguments.length == 3){
@@ -30,44 +30,44 @@ Camera.prototype.__defineGetter__('id', function(){
 });
 
 Camera.prototype.destroy = function(){
-  self.camera.destroy(this._handle.id);
+  self.camera.destroy(this._handle);
   this._handle = null;
 }
 
 Camera.prototype.setEyePoint = function( x, y, z ){
   self.camera.setEyePoint(
-    this._handle.id, x, y, z
+    this._handle, x, y, z
   );
 }
 
 Camera.prototype.lookAt = function( x1, y1, z1, x2, y2, z2 ){
   self.camera.lookAt(
-    this._handle.id, x1, y1, z1, x2, y2, z2
+    this._handle, x1, y1, z1, x2, y2, z2
   );
 }
 
 Camera.prototype.setViewDirection = function( x, y, z ){
   self.camera.setViewDirection(
-    this._handle.id, x, y, z
+    this._handle, x, y, z
   );
 }
 
 Camera.prototype.setOrientation = function( x, y, z ){
   self.camera.setOrientation(
-    this._handle.id, x, y, z
+    this._handle, x, y, z
   );
 }
 
 Camera.prototype.generateRay = function( u, v, aRatio ){
   var rayHandle = {};
-  self.camera.generateRay( this._handle.id, u, v, aRatio, rayHandle );
+  self.camera.generateRay( this._handle, u, v, aRatio, rayHandle );
   var ray = new Ray( rayHandle );
   return ray;
 }
 
 // (float verticalFovDegrees, float aspectRatio, float nearPlane, float farPlane)
 Camera.prototype.setPerspective = function( verticalFovDegrees, aspectRatio, nearPlane, farPlane ){
-  self.camera.setPerspective( this._handle.id,
+  self.camera.setPerspective( this._handle,
     verticalFovDegrees,
     aspectRatio,
     nearPlane,
@@ -77,7 +77,7 @@ Camera.prototype.setPerspective = function( verticalFovDegrees, aspectRatio, nea
 
 Camera.prototype.setCenterOfInterestPoint = function( x, y, z ){
   self.camera.setCenterOfInterestPoint(
-    this._handle.id, x, y, z
+    this._handle, x, y, z
   );
 }
 
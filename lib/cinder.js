@@ -35,10 +35,53 @@
  
     app.draw = __draw__;
     delete __draw__;
+    app.setPipelined = __pipeline__;
+    delete __pipeline__;
+    
+    // Decodes a packed event batch, ints: [type, code, charCode, modifiers] floats: [x, y, timestamp]
+    // The arrays are reused by the native side, so they are only valid during this call.
+    var handleEventBatch = function( count, ints, floats ){
+      var type, n, f;
+      for(var i = 0; i < count; i++){
+        n = i * 4;
+        f = i * 3;
+        type = ints[n];
+        
+        if(type == 10){
+          app.emit('resize', floats[f], floats[f + 1]);
+        }
+        else if(type == 20 || type == 30){
+          app.emit(type == 20 ? 'keydown' : 'keyup', {
+            charCode: ints[n + 1],
+            char: ints[n + 2],
+            modifiers: ints[n + 3]
+          });
+        }
+        else if(type == 40 || type == 50){
+          app.emit(type == 40 ? 'mousedown' : 'mouseup', {
+            x: floats[f],
+            y: floats[f + 1],
+            button: ints[n + 1],
+            modifiers: ints[n + 3]
+          });
+        }
+        else if(type == 60){
+          app.emit('mousemove', {
+            x: floats[f],
+            y: floats[f + 1],
+            modifiers: ints[n + 3]
+          });
+        }
+      }
+    };
     
     var handleRawEvent = function( type ){
+      // Event Batch
+      if(type == 2){
+        handleEventBatch(arguments[1], arguments[2], arguments[3]);
+      }
       // Resize Event
-      if(type == 10){
+      else if(type == 10){
         app.emit('resize', arguments[1], arguments[2]);
       }
       // Key Down
@@ -46,7 +89,8 @@
         // TODO: Make real key event with goodies
         app.emit('keydown', {
           charCode: arguments[1],
-          char: arguments[2]
+          char: arguments[2],
+          modifiers: arguments[3]
         });
       }
       // Key Up
@@ -54,18 +98,35 @@
         // TODO: Make real key event with goodies
         app.emit('keyup', {
           charCode: arguments[1],
-          char: arguments[2]
+          char: arguments[2],
+          modifiers: arguments[3]
         });
       }
       // Mouse Down
       else if(type == 40){
-        // TODO: Make real mouse event with goodies
-        app.emit('mousedown');
+        app.emit('mousedown', {
+          x: arguments[1],
+          y: arguments[2],
+          button: arguments[3],
+          modifiers: arguments[4]
+        });
       }
       // Mouse Up
       else if(type == 50){
-        // TODO: Make real mouse event with goodies
-        app.emit('mouseup');
+        app.emit('mouseup', {
+          x: arguments[1],
+          y: arguments[2],
+          button: arguments[3],
+          modifiers: arguments[4]
+        });
+      }
+      // Mouse Move (coalesced, latest position only)
+      else if(type == 60){
+        app.emit('mousemove', {
+          x: arguments[1],
+          y: arguments[2],
+          modifiers: arguments[4]
+        });
       }
       // File Drop
       else if(type == 100){
@@ -77,7 +138,7 @@
     };
 
     // Setup event handler and remove raw from global
-    __event__(handleRawEvent);
+    __event__(handleRawEvent, true);
     delete __event__;
 
     // Have global console
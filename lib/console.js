@@ -1,16 +1,42 @@
 var util = require('util');
 var self = this;
 
-exports.log = function(){
-  var lines = [];
+// Severity levels, matching LogLevel in AppConsole.h
+var INFO = 0;
+var WARN = 1;
+var ERROR = 2;
+
+// Multi line output is split into one record per line natively
+function write( level, args ){
   var output = '';
-  for(var i = 0; i < arguments.length; i++){
-    if(util.isUndefined(arguments[i])) arguments[i] = '[undefined]';
-    var str = arguments[i].toString();
-    output += ' ' + str;
-  }
-  var parts = output.split('\n');
-  for(var j = 0; j < parts.length; j++){
-    self.log(parts[j]);
+  for(var i = 0; i < args.length; i++){
+    var arg = args[i];
+    if(util.isUndefined(arg)) arg = '[undefined]';
+    output += ' ' + arg.toString();
   }
-}
\ No newline at end of file
+  self.log(output, level);
+}
+
+exports.log = exports.info = function(){
+  write(INFO, arguments);
+};
+
+exports.warn = function(){
+  write(WARN, arguments);
+};
+
+exports.error = function(){
+  write(ERROR, arguments);
+};
+
+/**
+ * Bounds the log history, the oldest lines are dropped once either
+ * maxLines or maxBytes is exceeded. Returns the memory now used by the log.
+ */
+exports.setCapacity = function( maxLines, maxBytes ){
+  return self.setLogCapacity(maxLines, maxBytes);
+};
+
+exports.showTimestamps = function( show ){
+  self.setLogTimestamps(show !== false);
+};
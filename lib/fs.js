@@ -1,6 +1,8 @@
 // File System
 
 var pathModule = require('path');
+var EventEmitter = require('events').EventEmitter;
+var util = require('util');
 
 var isWindows = process.platform === 'win32';
 var fs = exports;
@@ -22,8 +24,217 @@ fs.lstatSync = function(path) {
 };
 
 
-fs.readFileSync = function( path ) {
-  return self._fs.readFileSync( path );
+// Returns a string if an encoding is given (only utf8 is supported),
+// otherwise an ArrayBuffer backed by the memory mapped file. The ArrayBuffer follows
+// changes to the file on disk and truncating the file while it is in use crashes the app,
+// copy the data if the file may be rewritten.
+fs.readFileSync = function( path, options ) {
+  var encoding = typeof options === 'string' ? options : options && options.encoding;
+  return self._fs.readFileSync( path, !encoding );
+}
+
+//
+// Async versions run on a worker pool, callbacks are called with the next frame as callback(err, result).
+// Without a callback a Promise is returned.
+
+// Calls fn with a node style callback, or returns a Promise if there is none
+function callbackOrPromise( callback, fn ) {
+  if (typeof callback === 'function') {
+    fn(callback);
+    return;
+  }
+  return new Promise(function( resolve, reject ) {
+    fn(function( err, result ) {
+      if (err) reject(err);
+      else resolve(result);
+    });
+  });
+}
+
+fs.readFile = function( path, options, callback ) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = null;
+  }
+  var encoding = typeof options === 'string' ? options : options && options.encoding;
+  return callbackOrPromise(callback, function( cb ) {
+    if (!nullCheck(path, cb)) return;
+    self._fs.readFile( path, !encoding, cb );
+  });
+}
+
+// data is a string or binary (ArrayBuffer, typed array)
+fs.writeFile = function( path, data, options, callback ) {
+  if (typeof options === 'function') {
+    callback = options;
+  }
+  return callbackOrPromise(callback, function( cb ) {
+    if (!nullCheck(path, cb)) return;
+    self._fs.writeFile( path, data, cb );
+  });
+}
+
+fs.stat = function( path, callback ) {
+  return callbackOrPromise(callback, function( cb ) {
+    if (!nullCheck(path, cb)) return;
+    self._fs.stat( path, cb );
+  });
+}
+
+//
+// ReadStream
+// Emits 'data' (chunk), 'end', 'error' (err) and 'close'.
+// A chunk is a Uint8Array over a reused buffer, its contents are only valid during the 'data' handler,
+// copy it (or upload it, e.g. vbo.update(chunk, offset)) before returning.
+// pause() takes effect right away, chunks that were already on their way are copied and held
+// until resume(), where they are emitted before reading continues.
+// options: chunkSize (bytes, default 64k), readAhead (number of chunks buffered in the background, default 4)
+// A flowing stream is kept alive until it ends, a paused or ended stream is collected with its
+// file and buffers once it is no longer referenced.
+var ReadStream = function ReadStream( path, options ) {
+  if (!(this instanceof ReadStream)) {
+    return new ReadStream(path, options);
+  }
+  EventEmitter.call(this);
+
+  options = options || {};
+  this.path = path;
+  this.chunkSize = options.chunkSize || 64 * 1024;
+  this.readAhead = options.readAhead || 4;
+  this.bytesRead = 0;
+  this.paused = false;
+  this.closed = false;
+  // Arrived while paused: copied chunks, then the error or end that came with them
+  this._held = [];
+  this._heldErr = null;
+  this._heldEof = false;
+
+  nullCheck(path);
+
+  // Held by the stream, natively only while reading
+  var stream = this;
+  this._onReadFn = function( err, chunk, eof ) {
+    stream._onRead(err, chunk, eof);
+  };
+  this._handle = __handle__();
+  self._fs.createReadStream(this._handle, path, this.chunkSize, this.readAhead, this._onReadFn);
+};
+util.inherits(ReadStream, EventEmitter);
+fs.ReadStream = ReadStream;
+
+ReadStream.prototype._onRead = function( err, chunk, eof ) {
+  if (this.closed) return;
+  if (this.paused) {
+    // The native buffer is reused once this returns
+    if (chunk) this._held.push(new Uint8Array(chunk));
+    if (err) this._heldErr = err;
+    if (eof) this._heldEof = true;
+    return;
+  }
+  if (err) {
+    this.emit('error', err);
+    this.close();
+    return;
+  }
+  if (chunk) {
+    this.bytesRead += chunk.length;
+    this.emit('data', chunk);
+  }
+  if (eof && !this.closed) {
+    this.emit('end');
+    this.close();
+  }
+};
+
+ReadStream.prototype.pause = function() {
+  if (this.closed || this.paused) return this;
+  this.paused = true;
+  self._fs.pauseReadStream(this._handle, true);
+  return this;
+};
+
+ReadStream.prototype.resume = function() {
+  if (this.closed || !this.paused) return this;
+  this.paused = false;
+  
+  // A 'data' handler may pause or close the stream again
+  while (this._held.length && !this.paused && !this.closed) {
+    this._onRead(null, this._held.shift(), false);
+  }
+  if (this.paused || this.closed) return this;
+  
+  if (this._heldErr || this._heldEof) {
+    this._onRead(this._heldErr, null, this._heldEof);
+    return this;
+  }
+  self._fs.pauseReadStream(this._handle, false, this._onReadFn);
+  return this;
+};
+
+ReadStream.prototype.close = function() {
+  if (this.closed) return;
+  this.closed = true;
+  this._held = [];
+  self._fs.closeReadStream(this._handle);
+  this._handle = null;
+  this.emit('close');
+};
+ReadStream.prototype.destroy = ReadStream.prototype.close;
+
+fs.createReadStream = function( path, options ) {
+  return new ReadStream(path, options);
+};
+
+//
+// FSWatcher
+// Emits 'change' (eventType, filename) and 'close'.
+// A path that can not be watched throws from the constructor (fs.watch), there is no 'error' event.
+// eventType is 'change' or 'rename', events for the same file are delivered once per frame.
+// Editors saving through a temp file and rename are followed, the watch stays on the path.
+var FSWatcher = function FSWatcher( filename ) {
+  if (!(this instanceof FSWatcher)) {
+    return new FSWatcher(filename);
+  }
+  EventEmitter.call(this);
+
+  nullCheck(filename);
+
+  this.filename = filename;
+  this.closed = false;
+
+  var watcher = this;
+  this._handle = __handle__();
+  self._fs.watch(this._handle, filename, function( eventType, filename ) {
+    if (watcher.closed) return;
+    watcher.emit('change', eventType, filename);
+  });
+};
+util.inherits(FSWatcher, EventEmitter);
+fs.FSWatcher = FSWatcher;
+
+FSWatcher.prototype.close = function() {
+  if (this.closed) return;
+  this.closed = true;
+  self._fs.unwatch(this._handle);
+  this._handle = null;
+  this.emit('close');
+};
+
+// options are accepted for node compatibility, watching is never recursive
+fs.watch = function( filename, options, listener ) {
+  if (typeof options === 'function') {
+    listener = options;
+  }
+  var watcher = new FSWatcher(filename);
+  if (listener) {
+    watcher.on('change', listener);
+  }
+  return watcher;
+};
+
+// Module._findPath in one native call, see module.js
+fs._resolveModule = function( request, paths, exts ) {
+  return self._fs.resolveModule( request, paths, exts );
 }
 
 function nullCheck(path, callback) {
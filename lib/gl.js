@@ -33,4 +33,152 @@ module.exports.bindBufferBase = function( target, index, buffer ){
     throw new TypeError('Need a buffer to bind');
   }
   native_bindBufferBase( target, index, buffer.id, buffer.bufferType );
-}
\ No newline at end of file
+}
+
+//
+// Command buffer
+// Records gl calls into a persistent Float32Array and executes them
+// with a single native call on flush(). Layout: [opcode, operands...]
+var native_flush = this.gl.flush;
+var CMD = this.gl.COMMANDS;
+
+// Floats taken by the largest command, smaller buffers could not hold it after a flush
+var MAX_COMMAND_SIZE = 7;
+
+function CommandBuffer( size ){
+  size = size || 65536;
+  if(size < MAX_COMMAND_SIZE){
+    throw new RangeError('CommandBuffer size must be at least ' + MAX_COMMAND_SIZE);
+  }
+  this._data = new Float32Array(size);
+  this._pos = 0;
+}
+module.exports.CommandBuffer = CommandBuffer;
+
+// Make room for n floats, flushing early if the buffer would overflow
+CommandBuffer.prototype._reserve = function( n ){
+  if(this._pos + n > this._data.length){
+    this.flush();
+    if(n > this._data.length){
+      throw new RangeError('Command of ' + n + ' floats does not fit the CommandBuffer');
+    }
+  }
+  var pos = this._pos;
+  this._pos += n;
+  return pos;
+};
+
+CommandBuffer.prototype.flush = function(){
+  if(this._pos > 0){
+    native_flush( this._data, this._pos );
+    this._pos = 0;
+  }
+};
+
+CommandBuffer.prototype.pushMatrices = function(){
+  this._data[this._reserve(1)] = CMD.PUSH_MATRICES;
+};
+
+CommandBuffer.prototype.popMatrices = function(){
+  this._data[this._reserve(1)] = CMD.POP_MATRICES;
+};
+
+CommandBuffer.prototype.translate = function( x, y, z ){
+  var d = this._data, p = this._reserve(4);
+  d[p] = CMD.TRANSLATE; d[p + 1] = x; d[p + 2] = y; d[p + 3] = z || 0;
+};
+
+CommandBuffer.prototype.scale = function( x, y, z ){
+  var d = this._data, p = this._reserve(4);
+  d[p] = CMD.SCALE; d[p + 1] = x; d[p + 2] = y; d[p + 3] = z === undefined ? 1 : z;
+};
+
+// rotate( angle ) or rotate( w, x, y, z ) like gl.rotate
+CommandBuffer.prototype.rotate = function( w, x, y, z ){
+  var d = this._data, p;
+  if(arguments.length < 3){
+    p = this._reserve(2);
+    d[p] = CMD.ROTATE; d[p + 1] = w;
+    return;
+  }
+  p = this._reserve(5);
+  d[p] = CMD.ROTATE_QUAT; d[p + 1] = w; d[p + 2] = x || 0; d[p + 3] = y || 0; d[p + 4] = z || 0;
+};
+
+CommandBuffer.prototype.color = function( r, g, b, a ){
+  var d = this._data, p = this._reserve(5);
+  d[p] = CMD.COLOR; d[p + 1] = r; d[p + 2] = g; d[p + 3] = b; d[p + 4] = a === undefined ? 1 : a;
+};
+
+CommandBuffer.prototype.enable = function( cap ){
+  var d = this._data, p = this._reserve(2);
+  d[p] = CMD.ENABLE; d[p + 1] = cap;
+};
+
+CommandBuffer.prototype.disable = function( cap ){
+  var d = this._data, p = this._reserve(2);
+  d[p] = CMD.DISABLE; d[p + 1] = cap;
+};
+
+CommandBuffer.prototype.enableDepthRead = function(){
+  this._data[this._reserve(1)] = CMD.ENABLE_DEPTH_READ;
+};
+
+CommandBuffer.prototype.disableDepthRead = function(){
+  this._data[this._reserve(1)] = CMD.DISABLE_DEPTH_READ;
+};
+
+CommandBuffer.prototype.enableDepthWrite = function(){
+  this._data[this._reserve(1)] = CMD.ENABLE_DEPTH_WRITE;
+};
+
+CommandBuffer.prototype.disableDepthWrite = function(){
+  this._data[this._reserve(1)] = CMD.DISABLE_DEPTH_WRITE;
+};
+
+CommandBuffer.prototype.clear = function( r, g, b, a ){
+  var d = this._data, p = this._reserve(5);
+  d[p] = CMD.CLEAR; d[p + 1] = r || 0; d[p + 2] = g || 0; d[p + 3] = b || 0; d[p + 4] = a === undefined ? 1 : a;
+};
+
+CommandBuffer.prototype._six = function( cmd, a, b, c, e, f, g ){
+  var d = this._data, p = this._reserve(7);
+  d[p] = cmd; d[p + 1] = a; d[p + 2] = b; d[p + 3] = c; d[p + 4] = e; d[p + 5] = f; d[p + 6] = g;
+};
+
+CommandBuffer.prototype.drawCube = function( x, y, z, w, h, l ){
+  this._six(CMD.DRAW_CUBE, x, y, z, w, h, l);
+};
+
+CommandBuffer.prototype.drawColorCube = function( x, y, z, w, h, l ){
+  this._six(CMD.DRAW_COLOR_CUBE, x, y, z, w, h, l);
+};
+
+CommandBuffer.prototype.drawLine = function( x1, y1, z1, x2, y2, z2 ){
+  this._six(CMD.DRAW_LINE, x1, y1, z1, x2, y2, z2);
+};
+
+CommandBuffer.prototype.drawSphere = function( x, y, z, radius, segments ){
+  var d = this._data, p = this._reserve(6);
+  d[p] = CMD.DRAW_SPHERE; d[p + 1] = x; d[p + 2] = y; d[p + 3] = z;
+  d[p + 4] = radius; d[p + 5] = segments === undefined ? 12 : segments;
+};
+
+CommandBuffer.prototype.drawSolidCircle = function( x, y, radius ){
+  var d = this._data, p = this._reserve(4);
+  d[p] = CMD.DRAW_SOLID_CIRCLE; d[p + 1] = x; d[p + 2] = y; d[p + 3] = radius;
+};
+
+CommandBuffer.prototype.begin = function( mode ){
+  var d = this._data, p = this._reserve(2);
+  d[p] = CMD.BEGIN; d[p + 1] = mode;
+};
+
+CommandBuffer.prototype.end = function(){
+  this._data[this._reserve(1)] = CMD.END;
+};
+
+CommandBuffer.prototype.vertex = function( x, y, z ){
+  var d = this._data, p = this._reserve(4);
+  d[p] = CMD.VERTEX; d[p + 1] = x; d[p + 2] = y; d[p + 3] = z || 0;
+};
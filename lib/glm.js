@@ -8,7 +8,7 @@ var self = this;
 var Mat4 = function Mat4( handleOrOther ) {
   
   if(!handleOrOther){
-    this._handle = {};
+    this._handle = __handle__();
     self.glm.createMat4(this._handle);
   } else if(!handleOrOther.isMat4 && handleOrOther.id) {
     this._handle = handleOrOther;
@@ -28,7 +28,7 @@ Mat4.prototype.__defineGetter__('id', function(){
 });
 
 Mat4.prototype.destroy = function(){
-  self.glm.destroyMat4(this._handle.id);
+  self.glm.destroyMat4(this._handle);
   this._handle = null;
 }
 
@@ -36,12 +36,12 @@ Mat4.prototype.mult = function( otherMat4 ){
   if(!otherMat4.isMat4){
     throw new TypeError('Need a Mat4 to multiply with.');
   }
-  self.glm.multMat4(this._handle.id, otherMat4.id);
+  self.glm.multMat4(this._handle, otherMat4._handle);
 }
 
 
 exports.rotate = function( angle, x, y, z ){
-  var handle = {};
+  var handle = __handle__();
   self.glm.rotate( handle, angle, x, y, z );
   return new Mat4( handle );
 }
@@ -57,12 +57,12 @@ var Vec3 = function Vec3( x, y, z ) {
   this._data = { x: 0, y: 0, z: 0 };
 
   if(!x){
-    this._handle = {};
+    this._handle = __handle__();
     self.glm.createVec3(this._handle);
   } else if(!x.isVec3 && x.id) {
     this._handle = x;
   } else {
-    this._handle = {};
+    this._handle = __handle__();
     self.glm.createVec3( this._handle, x, y, z );
     this._data.x = x;
     this._data.y = y;
@@ -87,12 +87,12 @@ Vec3.prototype.__defineGetter__('id', function(){
 });
 
 Vec3.prototype.destroy = function(){
-  self.glm.destroyVec3(this._handle.id);
+  self.glm.destroyVec3(this._handle);
   this._handle = null;
 }
 
 Vec3.prototype.set = function( x, y, z ){
-  self.glm.setVec3(this._handle.id, x, y, z);
+  self.glm.setVec3(this._handle, x, y, z);
   this._data.x = x;
   this._data.y = y;
   this._data.z = z;
@@ -100,9 +100,9 @@ Vec3.prototype.set = function( x, y, z ){
 
 Vec3.prototype.add = function( x, y, z ){
   if(x.isVec3){
-    var result = self.glm.addVec3(this._handle.id, x.id);  
+    var result = self.glm.addVec3(this._handle, x._handle);  
   } else {
-    var result = self.glm.addVec3(this._handle.id, x, y, z);
+    var result = self.glm.addVec3(this._handle, x, y, z);
   }
   
   if(result){
@@ -81,83 +81,9 @@ Module.wrap = process.wrap;
 //   -> a
 //   -> a.<ext>
 //   -> a/index.<ext>
-
-function statPath( path ) {
-  //try {
-    return fs.statSync( path );
-  //} catch (ex) {}
-  return false;
-}
-
-// check if the directory is a package.json dir
-var packageMainCache = {};
-
-function readPackage(requestPath) {
-  if (hasOwnProperty(packageMainCache, requestPath)) {
-    return packageMainCache[requestPath];
-  }
-
-  var jsonPath = path.resolve(requestPath, 'package.json');
-  if(fs.existsSync(jsonPath)){
-    try {
-      var json = fs.readFileSync(jsonPath, 'utf8');
-    } catch(e) {
-      e.path = jsonPath;
-      e.message = 'Error loading ' + jsonPath + ': ' + e.message;
-      throw e;
-    }
-  } else {
-    return false;
-  }
-
-  try {
-    var pkg = packageMainCache[requestPath] = JSON.parse(json).main;
-  } catch (e) {
-    e.path = jsonPath;
-    e.message = 'Error parsing ' + jsonPath + ': ' + e.message;
-    throw e;
-  }
-  return pkg;
-}
-
-function tryPackage(requestPath, exts) {
-  var pkg = readPackage(requestPath);
-
-  if (!pkg) return false;
-
-  var filename = path.resolve(requestPath, pkg);
-  return tryFile(filename) || tryExtensions(filename, exts) ||
-         tryExtensions(path.resolve(filename, 'index'), exts);
-}
-
-// In order to minimize unnecessary lstat() calls,
-// this cache is a list of known-real paths.
-// Set to an empty object to reset.
-Module._realpathCache = {};
-
-// check if the file exists and is not a directory
-function tryFile(requestPath) {
-  var stats = statPath(requestPath);
-  if (stats && !stats.isDirectory) {
-    debug('Not a directory');
-    return fs.realpathSync(requestPath, Module._realpathCache);
-  }
-  return false;
-}
-
-// given a path check a the file exists with any of the set extensions
-function tryExtensions(p, exts) {
-  for (var i = 0, EL = exts.length; i < EL; i++) {
-    var filename = tryFile(p + exts[i]);
-
-    if (filename) {
-      return filename;
-    }
-  }
-  return false;
-}
-
-
+//
+// The search runs natively in one call (fs._resolveModule),
+// with directory listings cached until their mtime changes.
 Module._findPath = function( request, paths ) {
   var exts = Object.keys(Module._extensions);
 
@@ -165,45 +91,19 @@ Module._findPath = function( request, paths ) {
     paths = [''];
   }
 
-  var trailingSlash = (request.slice(-1) === '/');
-
-  var cacheKey = JSON.stringify({request: request, paths: paths});
+  var cacheKey = request + '\x00' + paths.join('\x00');
   if (Module._pathCache[cacheKey]) {
     return Module._pathCache[cacheKey];
   }
 
-  // For each path
-  for (var i = 0, PL = paths.length; i < PL; i++) {
-    var basePath = path.resolve(paths[i], request);
-    var filename;
-    
-    debug('_findPath basePath: ' + basePath);
-    
-    if (!trailingSlash) {
-      // try to join the request to the path
-      filename = tryFile(basePath);
-
-      if (!filename && !trailingSlash) {
-        // try it with each of the extensions
-        filename = tryExtensions(basePath, exts);
-      }
-    }
+  debug('_findPath request: ' + request);
 
-    if (!filename) {
-      filename = tryPackage(basePath, exts);
-    }
+  var filename = fs._resolveModule(request, paths, exts);
 
-    if (!filename) {
-      // try it with each of the extensions at "index"
-      filename = tryExtensions(path.resolve(basePath, 'index'), exts);
-    }
-
-    if (filename) {
-      Module._pathCache[cacheKey] = filename;
-      return filename;
-    }
+  if (filename) {
+    Module._pathCache[cacheKey] = filename;
   }
-  return false;
+  return filename;
 };
 
 // 'from' is the __dirname of the module.
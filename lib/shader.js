@@ -3,7 +3,18 @@
 var util = require('util');
 var self = this;
 
+// Bumped when any program was reloaded, cached uniform locations are resolved again after it
+var reloadGeneration = 0;
+
+self.shader.setReloadCallback(function( id, err ){
+  if(!err) reloadGeneration++;
+  if(Shader.onReload) Shader.onReload(id, err);
+});
+
 var Shader = function Shader( vert ) {
+  // Uniform locations by name, resolved once per program
+  this._locations = {};
+  
   if(!vert) return;
   
   this._handle = {};
@@ -48,14 +59,13 @@ Shader.prototype.bind = function() {
  * Does type checks (which can be improved, but are still slow)
  * Warning: Numbers are not diverted between Float and Integer,
  * if the Float is a .0 it will be an Integer.
+ * name can also be a location from getUniformLocation.
  */ 
 Shader.prototype.uniform = function( name, value ){
   if ( util.isInteger(value) ) {
-    console.log('int');
     self.shader.uniformInt(this._handle.id, name, value);
   } 
   else if ( util.isNumber(value) ) {
-    console.log('number');
     self.shader.uniformFloat(this._handle.id, name, value);
   } 
   else {
@@ -63,6 +73,22 @@ Shader.prototype.uniform = function( name, value ){
   }
 }
 
+/**
+ * Integer location of a uniform, -1 if not active in the program.
+ * Setters given the location skip the lookup by name.
+ */
+Shader.prototype.getUniformLocation = function( name ) {
+  if(this._generation !== reloadGeneration){
+    this._locations = {};
+    this._generation = reloadGeneration;
+  }
+  var location = this._locations[name];
+  if(location === undefined){
+    location = this._locations[name] = self.shader.getUniformLocation(this._handle.id, name);
+  }
+  return location;
+};
+
 Shader.prototype.uniformInt = function( name, value ) {
   self.shader.uniformInt(this._handle.id, name, value);
 };
@@ -79,6 +105,88 @@ Shader.prototype.uniformVec3 = function( name, vec ) {
 };
 
 
+// Components per uniform type, for layouts
+Shader.FLOAT = 1;
+Shader.VEC2 = 2;
+Shader.VEC3 = 3;
+Shader.VEC4 = 4;
+Shader.MAT3 = 9;
+Shader.MAT4 = 16;
+
+/**
+ * Builds a layout for uniforms() from [name, components, count] entries,
+ * e.g. [['uColor', Shader.VEC4], ['uLights', Shader.VEC3, 4]]
+ */
+Shader.prototype.uniformLayout = function( spec ) {
+  var layout = new Int32Array(spec.length * 3);
+  for(var i = 0; i < spec.length; i++){
+    layout[i * 3] = this.getUniformLocation(spec[i][0]);
+    layout[i * 3 + 1] = spec[i][1];
+    layout[i * 3 + 2] = spec[i][2] || 1;
+  }
+  return layout;
+};
+
+/**
+ * Uploads all uniforms of a layout from one Float32Array, values in layout order.
+ */
+Shader.prototype.uniforms = function( data, layout ) {
+  self.shader.uniforms(this._handle.id, data, layout);
+};
+
+/**
+ * Reads the named uniform block from the Vbo bound at binding (see Vbo.bindBase).
+ */
+Shader.prototype.uniformBlock = function( name, binding ) {
+  self.shader.uniformBlock(this._handle.id, name, binding);
+};
+
+/**
+ * Compiles and links a Format in the background,
+ * callback(err, shader) is called with the next frame once the shader can be bound.
+ */
+Shader.createAsync = function( format, callback ){
+  if(!format || !format.isFormat){
+    throw new TypeError('Shader.createAsync needs a Shader.Format');
+  }
+  
+  var shader = new Shader();
+  shader._handle = {};
+  
+  self.shader.createAsync(shader._handle, format.id, function(err){
+    if(err) return callback(err);
+    callback(null, shader);
+  });
+  
+  return shader;
+};
+
+/**
+ * Time spent compiling and linking programs so far,
+ * {programs, seconds, slowest, slowestName, cached}
+ * cached counts programs loaded from the program binary cache instead of compiled.
+ */
+Shader.getCompileStats = function() {
+  return self.shader.getCompileStats();
+};
+
+/**
+ * Shaders created from files are recompiled when the files change (enabled by default),
+ * a program that fails to compile keeps running and the error goes to the console.
+ * Disabling stops watching existing shaders, enabling affects shaders created afterwards.
+ */
+Shader.setHotReload = function( enabled ) {
+  self.shader.setHotReload(!!enabled);
+};
+
+/**
+ * Optional hook, Shader.onReload = function(id, err){} is called after a reload attempt.
+ * A reloaded program starts without uniform values, set all uniforms of the shader again
+ * before it is used next. Uniform block bindings are carried over.
+ * Layouts from uniformLayout() should be rebuilt, locations may have moved.
+ */
+Shader.onReload = null;
+
 Shader.getStockColor = function() {
   var handle = {};
   self.shader.getStockColor(handle);
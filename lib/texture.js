@@ -31,3 +31,26 @@ TextureWrapper.prototype.bind = function(){
   self.texture.bind(this._handle.id);
 }
 
+/**
+ * Decodes and uploads the image in the background,
+ * callback(err, texture) is called with the next frame once the texture can be used.
+ */
+TextureWrapper.loadAsync = function(imagePath, callback){
+  var tex = new TextureWrapper();
+  tex._handle = {};
+  
+  var error = self.texture.loadAsync(tex._handle, imagePath, function(err){
+    if(err) return callback(err);
+    callback(null, tex);
+  });
+  
+  // Asset not found, report it asynchronously like every other failure
+  if(error){
+    process.nextFrame(function(){
+      callback(new Error(error));
+    });
+  }
+  
+  return tex;
+}
+
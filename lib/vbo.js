@@ -12,7 +12,7 @@ var Vbo = function Vbo( target, data, usage ) {
     return new Vbo(target, data, usage);
   }
   
-  this._handle = {};
+  this._handle = __handle__();
   
   if(arguments.length == 1){
     self.vbo.create(this._handle, target);
@@ -21,11 +21,15 @@ var Vbo = function Vbo( target, data, usage ) {
     self.vbo.create(this._handle, target, data, usage);
   }
 
-  this._data = data;
+  this._length = typeof data === 'number' ? undefined : data && data.length;
 
 };
 
-Vbo.prototype.__defineGetter__('size', function(){ return this._data.length; });
+// Element count of the array the buffer was created (or last fully updated) with
+Vbo.prototype.__defineGetter__('size', function(){ return this._length; });
+
+// Byte size of the buffer storage
+Vbo.prototype.__defineGetter__('byteSize', function(){ return self.vbo.getSize(this._handle); });
 
 // Convinience flag for type checking
 Vbo.prototype.__defineGetter__('isVbo', function(){ return true; });
@@ -39,14 +43,56 @@ Vbo.prototype.__defineGetter__('id', function(){
 });
 
 Vbo.prototype.destroy = function(){
-  self.vbo.destroy(this._handle.id);
+  self.vbo.destroy(this._handle);
   this._handle = null;
 };
 
 Vbo.prototype.bind = function(){
-  self.vbo.bind(this._handle.id);
+  self.vbo.bind(this._handle);
 };
 
 Vbo.prototype.unbind = function(){
-  self.vbo.unbind(this._handle.id);
+  self.vbo.unbind(this._handle);
+};
+
+/**
+ * Uploads a typed array at byteOffset (default 0) without copying through js values.
+ * With orphan set, the old storage is dropped first to avoid a pipeline stall.
+ */
+Vbo.prototype.update = function( data, byteOffset, orphan ){
+  self.vbo.update(this._handle, data, byteOffset || 0, !!orphan);
+  if(!byteOffset && data.length >= (this._length || 0)){
+    this._length = data.length;
+  }
+};
+
+Vbo.prototype.orphan = function(){
+  self.vbo.orphan(this._handle);
 };
+
+/**
+ * Returns an ArrayBuffer on the mapped buffer memory, valid until unmap() or destroy(),
+ * after that it is neutered (zero length). update() and orphan() throw while mapped.
+ * Default access is write-only with invalidation.
+ */
+Vbo.prototype.map = function( access ){
+  return self.vbo.map(this._handle, access);
+};
+
+Vbo.prototype.unmap = function(){
+  self.vbo.unmap(this._handle);
+};
+
+/**
+ * Binds the buffer (or a byte range of it) to a uniform buffer binding point.
+ * Update it once per frame, every shader with a uniformBlock at that binding reads it.
+ */
+Vbo.prototype.bindBase = function( index, byteOffset, byteSize ){
+  self.vbo.bindBase(this._handle, index, byteOffset, byteSize);
+};
+
+Vbo.MAP_READ_BIT = self.vbo.MAP_READ_BIT;
+Vbo.MAP_WRITE_BIT = self.vbo.MAP_WRITE_BIT;
+Vbo.MAP_INVALIDATE_RANGE_BIT = self.vbo.MAP_INVALIDATE_RANGE_BIT;
+Vbo.MAP_INVALIDATE_BUFFER_BIT = self.vbo.MAP_INVALIDATE_BUFFER_BIT;
+Vbo.MAP_UNSYNCHRONIZED_BIT = self.vbo.MAP_UNSYNCHRONIZED_BIT;
@@ -4,3 +4,8 @@ var self = this;
 vm.runInThisContext = function( script, filename ) {
   return self._vm.runInThisContext( script, filename );
 }
+
+// Code cache counters: { hits, misses, rejected, natives: { hits, misses, rejected } }
+vm.getCacheStats = function() {
+  return self._vm.getCacheStats();
+}
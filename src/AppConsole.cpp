@@ -7,16 +7,179 @@
 //
 
 #include <stdio.h>
+#include <chrono>
 #include "AppConsole.h"
 
 namespace cjs {
-  
-bool AppConsole::sInitialized = false;
-bool AppConsole::sChanged = false;
-int AppConsole::sNumLinesToShow = 10;
-int AppConsole::sMaxLines = 100;
-cinder::gl::TextureRef AppConsole::_sTexture;
-std::vector<std::string> AppConsole::sLines = std::vector<std::string>();
+
+std::mutex AppConsole::sMutex;
+std::vector<LogRecord> AppConsole::sRecords;
+size_t AppConsole::sHead = 0;
+size_t AppConsole::sCount = 0;
+size_t AppConsole::sBytes = 0;
+size_t AppConsole::sMaxLines = 1000;
+size_t AppConsole::sMaxBytes = 256 * 1024;
+uint64_t AppConsole::sTotal = 0;
+bool AppConsole::sShowTimestamps = false;
+std::vector<TextMesh> AppConsole::sRows;
+std::vector<uint64_t> AppConsole::sRowRecords;
 int AppConsole::linesToShow = 20;
 
-}
\ No newline at end of file
+static std::chrono::steady_clock::time_point sStart = std::chrono::steady_clock::now();
+
+void AppConsole::initialize(){
+  std::lock_guard<std::mutex> lck( sMutex );
+  sStart = std::chrono::steady_clock::now();
+  if(sRecords.empty()){
+    sRecords.resize(sMaxLines);
+  }
+}
+
+void AppConsole::log( const std::string &str, LogLevel level ){
+  double timestamp = std::chrono::duration<double>(std::chrono::steady_clock::now() - sStart).count();
+  
+  std::lock_guard<std::mutex> lck( sMutex );
+  size_t start = 0;
+  while( true ) {
+    size_t end = str.find('\n', start);
+    push( str.substr(start, end == std::string::npos ? std::string::npos : end - start), level, timestamp );
+    if(end == std::string::npos) break;
+    start = end + 1;
+  }
+}
+
+void AppConsole::push( std::string text, LogLevel level, double timestamp ){
+  if(sRecords.empty()){
+    sRecords.resize(sMaxLines);
+  }
+  
+  if(text.size() > kMaxLineLength){
+    text.resize(kMaxLineLength);
+  }
+  
+  size_t bytes = text.size() + sizeof(LogRecord);
+  while(sCount > 0 && (sCount == sRecords.size() || sBytes + bytes > sMaxBytes)){
+    evict();
+  }
+  
+  LogRecord& record = sRecords[sHead];
+  record.text.swap(text);
+  record.level = level;
+  record.timestamp = timestamp;
+  
+  sHead = (sHead + 1) % sRecords.size();
+  sCount++;
+  sBytes += bytes;
+  sTotal++;
+}
+
+// Drops the oldest record and releases its string
+void AppConsole::evict(){
+  LogRecord& record = sRecords[(sHead + sRecords.size() - sCount) % sRecords.size()];
+  sBytes -= record.text.size() + sizeof(LogRecord);
+  std::string().swap(record.text);
+  sCount--;
+}
+
+void AppConsole::setCapacity( size_t maxLines, size_t maxBytes ){
+  std::lock_guard<std::mutex> lck( sMutex );
+  
+  // Move the newest records that fit over into the new ring
+  std::vector<LogRecord> records( std::max<size_t>(maxLines, 1) );
+  size_t keep = std::min(sCount, records.size());
+  size_t bytes = 0;
+  for(size_t i = 0; i < keep; i++){
+    records[i] = std::move(sRecords[(sHead + sRecords.size() - keep + i) % sRecords.size()]);
+    bytes += records[i].text.size() + sizeof(LogRecord);
+  }
+  
+  sRecords.swap(records);
+  sHead = keep % sRecords.size();
+  sCount = keep;
+  sBytes = bytes;
+  sMaxLines = sRecords.size();
+  sMaxBytes = maxBytes;
+  
+  while(sCount > 0 && sBytes > sMaxBytes){
+    evict();
+  }
+}
+
+size_t AppConsole::getMemoryUsage(){
+  std::lock_guard<std::mutex> lck( sMutex );
+  return sBytes + sRecords.capacity() * sizeof(LogRecord);
+}
+
+void AppConsole::setShowTimestamps( bool show ){
+  std::lock_guard<std::mutex> lck( sMutex );
+  if(show != sShowTimestamps){
+    sShowTimestamps = show;
+    sRowRecords.assign(sRowRecords.size(), UINT64_MAX);
+  }
+}
+
+void AppConsole::draw( cinder::vec2 &pos ){
+  size_t visible;
+  uint64_t first;
+  
+  // Rows to lay out, copied under the lock and rasterized after it is released,
+  // so logging threads never wait for glyph rendering
+  struct RowUpdate {
+    size_t row;
+    std::string text;
+    cinder::ColorA color;
+  };
+  std::vector<RowUpdate> updates;
+  
+  {
+    std::lock_guard<std::mutex> lck( sMutex );
+    
+    if(sRows.empty()){
+      sRows.resize(linesToShow);
+      sRowRecords.assign(linesToShow, UINT64_MAX);
+    }
+    
+    visible = std::min(sCount, (size_t)linesToShow);
+    first = sTotal - visible;
+    
+    // Only rows that now show a different record are laid out again
+    for(size_t i = 0; i < visible; i++){
+      uint64_t n = first + i;
+      size_t row = n % linesToShow;
+      if(sRowRecords[row] == n){
+        continue;
+      }
+      
+      const LogRecord& record = sRecords[(sHead + sRecords.size() - visible + i) % sRecords.size()];
+      
+      std::string text = record.text;
+      if(sShowTimestamps){
+        char stamp[32];
+        snprintf(stamp, sizeof(stamp), "%9.3f ", record.timestamp);
+        text = stamp + text;
+      }
+      
+      updates.push_back({ row, std::move(text), record.level == LOG_ERROR ? cinder::ColorA( 1, 0.4f, 0.4f, 1 )
+        : record.level == LOG_WARN ? cinder::ColorA( 1, 0.85f, 0.3f, 1 )
+        : cinder::ColorA( 1, 1, 1, 1 ) });
+      sRowRecords[row] = n;
+    }
+  }
+  
+  // Rows are only touched by the drawing thread
+  for(RowUpdate& update : updates){
+    sRows[update.row].setText( update.text, update.color );
+  }
+  
+  float lineHeight = GlyphAtlas::getDefault()->getLineHeight();
+  
+  cinder::gl::pushMatrices();
+  cinder::gl::translate(2, pos.y - visible * lineHeight, 0);
+  for(size_t i = 0; i < visible; i++){
+    sRows[(first + i) % linesToShow].draw();
+    cinder::gl::translate(0, lineHeight, 0);
+  }
+  cinder::gl::popMatrices();
+}
+
+}
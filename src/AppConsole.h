@@ -11,67 +11,71 @@
 
 #include "cinder/app/App.h"
 #include "cinder/gl/gl.h"
-#include "cinder/gl/Texture.h"
-#include "cinder/Text.h"
 #include "cinder/Color.h"
+#include "utils/GlyphText.hpp"
 
 #include <vector>
 #include <string>
+#include <mutex>
+#include <stdint.h>
 
 /**
  * AppConsole
  * Provides a visual logging interface component for the GL render context
- * TODO: Optimize, currently very energy hungry due to the constant texture creation
+ * Records are kept in a fixed capacity ring, bounded by line count and bytes, the oldest are dropped.
+ * Each visible row has its own text mesh, appending a line only lays out that line.
  */
 
 namespace cjs {
 
+enum LogLevel {
+  LOG_INFO = 0,
+  LOG_WARN = 1,
+  LOG_ERROR = 2
+};
+
+struct LogRecord {
+  std::string text;
+  LogLevel level;
+  double timestamp; // Seconds since the console was initialized
+};
+
 class AppConsole {
   public:
-    inline static void initialize(){
-      
-    }
+    static void initialize();
   
-    inline static void log( std::string str ) {
-      sLines.push_back( str );
-      
-      if(sLines.size() > 100){
-        // TODO: Remove previous lines from buffer
-      }
-      sChanged = true;
-    }
-    
-    // Draw
-    inline static void draw( cinder::vec2 &pos ){
-      
-      if( sChanged ) {
-        sChanged = false;
-        
-        cinder::TextLayout text;
-        text.setColor( cinder::ColorA( 1, 1, 1, 1 ) );
-        
-        int end = sLines.size() > linesToShow ? linesToShow : sLines.size();
-        
-        for(std::vector<std::string>::iterator it = sLines.end() - end; it != sLines.end(); ++it) {
-          text.addLine(*it);
-        }
-        
-        _sTexture = cinder::gl::Texture::create( text.render() );
-      }
-      
-      cinder::gl::pushMatrices();
-      cinder::gl::translate(2, pos.y - linesToShow * 12, 0);
-      cinder::gl::draw( _sTexture );
-      cinder::gl::popMatrices();
-    }
+    // Thread safe, multi line strings are split into one record per line
+    static void log( const std::string &str, LogLevel level = LOG_INFO );
+  
+    // Limits, records over either limit are dropped oldest first
+    static void setCapacity( size_t maxLines, size_t maxBytes );
+    static size_t getMemoryUsage();
+  
+    static void setShowTimestamps( bool show );
+  
+    // Draw, bottom aligned at pos.y
+    static void draw( cinder::vec2 &pos );
     
   private:
-    static bool sInitialized;
-    static bool sChanged;
-    static std::vector<std::string> sLines;
-    static int sNumLinesToShow;
-    static int sMaxLines;
-    static cinder::gl::TextureRef _sTexture;
+    static void push( std::string text, LogLevel level, double timestamp );
+    static void evict();
+  
+    // Longer lines are cut, so a single record can not exceed the byte budget
+    static const size_t kMaxLineLength = 1024;
+  
+    static std::mutex sMutex;
+    static std::vector<LogRecord> sRecords;
+    static size_t sHead;
+    static size_t sCount;
+    static size_t sBytes;
+    static size_t sMaxLines;
+    static size_t sMaxBytes;
+    static uint64_t sTotal;
+    static bool sShowTimestamps;
+  
+    // Row meshes, record number n is shown by sRows[n % linesToShow]
+    static std::vector<TextMesh> sRows;
+    static std::vector<uint64_t> sRowRecords;
     static int linesToShow;
 };
   
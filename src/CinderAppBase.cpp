@@ -10,6 +10,6 @@
 
 namespace cjs {
   
-  std::map<std::string, std::shared_ptr<PipeModule>> CinderAppBase::NAMED_MODULES;
+  std::vector<std::shared_ptr<PipeModule>> CinderAppBase::NATIVE_MODULES(natives_count);
 
 }
\ No newline at end of file
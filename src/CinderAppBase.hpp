@@ -29,6 +29,7 @@
 
 #include "v8.h"
 #include "PipeModule.hpp"
+#include "js_natives.h"
 
 namespace cjs {
 
@@ -50,19 +51,25 @@ namespace cjs {
         
         MODULES.push_back( mod );
         
-        if(NAMED_MODULES.find(mod->getName())->second){
+        // Modules are indexed like their js counterpart in the natives table
+        int index = findNative(mod->getName().c_str());
+        if(index < 0){
+          return true;
+        }
+        
+        if(NATIVE_MODULES[index]){
           std::string msg = "Module '" + mod->getName() + "' already exists.";
           throw std::runtime_error(msg.c_str());
         }
         
-        NAMED_MODULES[mod->getName()] = mod;
+        NATIVE_MODULES[index] = mod;
         return true;
       }
     
       static bool shutdownInProgress;
     protected:
       std::vector<std::shared_ptr<PipeModule>> MODULES;
-      static std::map<std::string, std::shared_ptr<PipeModule>> NAMED_MODULES;
+      static std::vector<std::shared_ptr<PipeModule>> NATIVE_MODULES; // natives_count entries
       v8::Isolate* mIsolate;
       v8::Local<v8::ObjectTemplate> mGlobal;
       v8::Persistent<v8::Context> pContext;
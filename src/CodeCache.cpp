@@ -0,0 +1,143 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <string.h>
+
+#include "CodeCache.hpp"
+
+using namespace v8;
+using namespace std;
+
+namespace cjs {
+
+static const uint32_t kCodeCacheMagic = 0x434a5343; // CJSC
+static const char* kKindDirectories[] = { "natives", "scripts" };
+
+cinder::fs::path CodeCache::_sDirectory;
+uint32_t CodeCache::_sVersionHash = 0;
+CodeCache::Stats CodeCache::_sStats[CodeCache::NUM_KINDS];
+
+uint32_t CodeCache::hash( const char* data, size_t length, uint32_t seed ){
+  uint32_t h = seed;
+  for(size_t i = 0; i < length; i++){
+    h ^= (uint8_t)data[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void CodeCache::setDirectory( const cinder::fs::path& dir ){
+  boost::system::error_code ec;
+  for(int i = 0; i < NUM_KINDS; i++){
+    cinder::fs::create_directories(dir / kKindDirectories[i], ec);
+    if(ec){
+      cout << "Code cache disabled, cannot create " << dir << ": " << ec.message() << endl;
+      _sDirectory.clear();
+      return;
+    }
+  }
+  _sDirectory = dir;
+  
+  const char* version = V8::GetVersion();
+  _sVersionHash = hash(version, strlen(version));
+}
+
+bool CodeCache::read( const cinder::fs::path& file, uint32_t sourceHash, std::vector<uint8_t>* data ){
+  ifstream in(file.string(), ios::binary);
+  if(!in) return false;
+  
+  FileHeader header;
+  if(!in.read((char*)&header, sizeof(header))) return false;
+  if(header.magic != kCodeCacheMagic || header.versionHash != _sVersionHash
+    || header.sourceHash != sourceHash || header.length == 0){
+    return false;
+  }
+  
+  data->resize(header.length);
+  return (bool)in.read((char*)data->data(), header.length);
+}
+
+void CodeCache::write( const cinder::fs::path& file, uint32_t sourceHash, const uint8_t* data, int length ){
+  // Write to a temporary file first, so a concurrent launch never reads half a cache
+  cinder::fs::path tmp = file;
+  tmp += ".tmp";
+  {
+    ofstream out(tmp.string(), ios::binary | ios::trunc);
+    if(!out) return;
+    FileHeader header = { kCodeCacheMagic, _sVersionHash, sourceHash, (uint32_t)length };
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)data, length);
+    if(!out) return;
+  }
+  boost::system::error_code ec;
+  cinder::fs::rename(tmp, file, ec);
+}
+
+Local<Script> CodeCache::compile( Isolate* isolate, Local<String> source, Local<String> filename,
+  Kind kind, const std::string& key, uint32_t salt ){
+  EscapableHandleScope scope(isolate);
+  
+  ScriptOrigin origin(filename);
+  
+  if(_sDirectory.empty()){
+    ScriptCompiler::Source scriptSource(source, origin);
+    return scope.Escape(ScriptCompiler::Compile(isolate, &scriptSource));
+  }
+  
+  String::Utf8Value utf8Source(source);
+  uint32_t sourceHash = hash(*utf8Source, utf8Source.length());
+  if(salt){
+    sourceHash = hash((const char*)&salt, sizeof(salt), sourceHash);
+  }
+  cinder::fs::path file = _sDirectory / kKindDirectories[kind] / (key + ".jscache");
+  Stats& stats = _sStats[kind];
+  
+  // Consume
+  std::vector<uint8_t> data;
+  if(read(file, sourceHash, &data)){
+    ScriptCompiler::CachedData* cached = new ScriptCompiler::CachedData(data.data(), (int)data.size());
+    ScriptCompiler::Source scriptSource(source, origin, cached); // Takes ownership of cached, not of data
+    Local<Script> script = ScriptCompiler::Compile(isolate, &scriptSource, ScriptCompiler::kConsumeCodeCache);
+    
+    if(!scriptSource.GetCachedData()->rejected){
+      stats.hits++;
+      return scope.Escape(script);
+    }
+    stats.rejected++;
+  } else {
+    stats.misses++;
+  }
+  
+  // Produce
+  ScriptCompiler::Source scriptSource(source, origin);
+  Local<Script> script = ScriptCompiler::Compile(isolate, &scriptSource, ScriptCompiler::kProduceCodeCache);
+  
+  const ScriptCompiler::CachedData* produced = scriptSource.GetCachedData();
+  if(!script.IsEmpty() && produced && produced->length > 0){
+    write(file, sourceHash, produced->data, produced->length);
+  }
+  
+  return scope.Escape(script);
+}
+
+} // namespace cjs
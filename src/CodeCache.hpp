@@ -0,0 +1,90 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CodeCache_hpp_
+#define _CodeCache_hpp_
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "cinder/Filesystem.h"
+#include "v8.h"
+
+//
+// On-disk V8 code cache for scripts that are compiled on every launch,
+// cinder.js and the natives (NATIVE) and user modules loaded through vm.runInThisContext (SCRIPT).
+//
+// The first launch compiles from source with kProduceCodeCache and writes the cache data to
+// <directory>/<kind>/<key>.jscache, later launches compile with kConsumeCodeCache instead.
+// A cache file carries a hash of the V8 version and of the compiled source (plus a caller salt,
+// the file mtime for user modules), a file that does not match, or data V8 rejects
+// (different build or flags), is ignored and rewritten.
+// Without a directory set scripts are compiled from source only.
+
+namespace cjs {
+
+class CodeCache {
+  public:
+  enum Kind {
+    NATIVE = 0,
+    SCRIPT = 1,
+    NUM_KINDS
+  };
+  
+  static void setDirectory( const cinder::fs::path& dir );
+  static const cinder::fs::path& getDirectory(){ return _sDirectory; }
+  
+  // Compiles source, using and updating the cache file for key
+  static v8::Local<v8::Script> compile( v8::Isolate* isolate, v8::Local<v8::String> source,
+    v8::Local<v8::String> filename, Kind kind, const std::string& key, uint32_t salt = 0 );
+  
+  // FNV-1a
+  static uint32_t hash( const char* data, size_t length, uint32_t seed = 2166136261u );
+  
+  struct Stats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t rejected = 0;
+  };
+  static const Stats& getStats( Kind kind ){ return _sStats[kind]; }
+  
+  private:
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t versionHash;
+    uint32_t sourceHash;
+    uint32_t length;
+  };
+  
+  static bool read( const cinder::fs::path& file, uint32_t sourceHash, std::vector<uint8_t>* data );
+  static void write( const cinder::fs::path& file, uint32_t sourceHash, const uint8_t* data, int length );
+  
+  static cinder::fs::path _sDirectory;
+  static uint32_t _sVersionHash;
+  static Stats _sStats[NUM_KINDS];
+};
+
+} // namespace cjs
+
+#endif
@@ -0,0 +1,169 @@
+//
+//  EventQueue.h
+//  cinderjs
+//
+//  Fixed capacity single producer / single consumer event ring.
+//  The producer is the Cinder main thread (input callbacks), the consumer is the v8 event thread.
+//  Events are plain structs copied into preallocated slots, pushing and popping never allocate or lock.
+//
+
+#ifndef __cinderjs__EventQueue__
+#define __cinderjs__EventQueue__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cjs {
+
+// Modifier bits in RawEvent::modifiers
+enum EventModifier {
+  CJS_MOD_SHIFT = 1,
+  CJS_MOD_ALT = 2,
+  CJS_MOD_CTRL = 4,
+  CJS_MOD_META = 8
+};
+
+struct RawEvent {
+  int type;           // EventType
+  float x;            // Mouse position
+  float y;
+  int code;           // Key code or mouse button
+  uint32_t charCode;  // Key char
+  uint32_t modifiers; // EventModifier bits
+  double timestamp;   // App elapsed seconds
+};
+
+template<class T, size_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+  public:
+  SpscRing() : mHead(0), mTail(0) {}
+
+  // Producer only, false if full
+  inline bool push( const T& item ) {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    if(head - mTail.load(std::memory_order_acquire) >= N){
+      return false;
+    }
+    mItems[head & (N - 1)] = item;
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only, false if empty
+  inline bool pop( T* item ) {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if(tail == mHead.load(std::memory_order_acquire)){
+      return false;
+    }
+    *item = mItems[tail & (N - 1)];
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  inline bool isNotEmpty() const {
+    return mTail.load(std::memory_order_acquire) != mHead.load(std::memory_order_acquire);
+  }
+
+  private:
+  // Head and tail on separate cache lines, so producer and consumer do not false share
+  alignas(64) std::atomic<size_t> mHead;
+  alignas(64) std::atomic<size_t> mTail;
+  T mItems[N];
+};
+
+//
+// Event ring with mouse move coalescing.
+// Moves following each other share one marker in the ring, it carries the latest position when popped.
+// Any other event ends the coalescing: the open marker keeps the position it was pushed with,
+// a newer position is queued as a move of its own before the event, later moves get a new marker.
+// So a move, a click and another move are never reordered.
+template<size_t N>
+class EventQueue {
+  public:
+  EventQueue() : mOpenMarker(0), mMoveX(0), mMoveY(0), mMoveModifiers(0) {}
+
+  // Producer
+  inline bool push( const RawEvent& evt ) {
+    // Close the open marker, the consumer did not pop it yet
+    if(mOpenMarker.exchange(0, std::memory_order_acq_rel) != 0 &&
+       (mLastMove.x != mMarkerMove.x || mLastMove.y != mMarkerMove.y || mLastMove.modifiers != mMarkerMove.modifiers)){
+      pushRaw(mLastMove);
+    }
+    return pushRaw(evt);
+  }
+
+  // Producer, moveType is the EventType the marker is pushed with
+  inline void pushMove( int moveType, float x, float y, uint32_t modifiers, double timestamp ) {
+    mMoveX.store(x, std::memory_order_relaxed);
+    mMoveY.store(y, std::memory_order_relaxed);
+    mMoveModifiers.store(modifiers, std::memory_order_relaxed);
+    mLastMove = { moveType, x, y, 0, 0, modifiers, timestamp };
+
+    // Only the first move since the marker was popped or closed enters the ring.
+    // The marker is open before it is visible to the consumer, which closes it on pop.
+    if(mOpenMarker.load(std::memory_order_acquire) == 0){
+      if(++mMarkerSeq == 0) mMarkerSeq = 1;
+      mMarkerMove = mLastMove;
+      mMarkerMove.code = (int)mMarkerSeq;
+      mOpenMarker.store(mMarkerSeq, std::memory_order_release);
+      if(!pushRaw(mMarkerMove)){
+        mOpenMarker.store(0, std::memory_order_release);
+      }
+    }
+  }
+
+  // Consumer, fills in the latest coordinates for a marker that is still open
+  inline bool pop( RawEvent* evt, int moveType ) {
+    if(!mRing.pop(evt)){
+      return false;
+    }
+    if(evt->type == moveType && evt->code != 0){
+      // Close first, a move arriving after this point queues a new marker
+      uint32_t marker = (uint32_t)evt->code;
+      if(mOpenMarker.compare_exchange_strong(marker, 0, std::memory_order_acq_rel)){
+        evt->x = mMoveX.load(std::memory_order_relaxed);
+        evt->y = mMoveY.load(std::memory_order_relaxed);
+        evt->modifiers = mMoveModifiers.load(std::memory_order_relaxed);
+      }
+      evt->code = 0;
+    }
+    return true;
+  }
+
+  inline bool isNotEmpty() const {
+    return mRing.isNotEmpty();
+  }
+
+  // Events lost because the ring was full (producer side count)
+  inline uint32_t dropped() const {
+    return mDropped;
+  }
+
+  private:
+  inline bool pushRaw( const RawEvent& evt ) {
+    if(!mRing.push(evt)){
+      mDropped++;
+      return false;
+    }
+    return true;
+  }
+
+  SpscRing<RawEvent, N> mRing;
+  std::atomic<uint32_t> mOpenMarker; // Sequence number of the marker still in the ring and open, 0 if none
+  std::atomic<float> mMoveX;
+  std::atomic<float> mMoveY;
+  std::atomic<uint32_t> mMoveModifiers;
+  
+  // Producer only
+  uint32_t mMarkerSeq = 0;
+  RawEvent mMarkerMove = {};
+  RawEvent mLastMove = {};
+  uint32_t mDropped = 0;
+};
+
+} // namespace cjs
+
+#endif /* defined(__cinderjs__EventQueue__) */
@@ -0,0 +1,350 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <thread>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#endif
+
+#include "FileWatcher.hpp"
+
+using namespace std;
+
+namespace cjs {
+
+namespace {
+  
+  struct Watch {
+    std::string dir;
+    std::string name; // Empty when watching the directory itself
+    FileWatcher::Callback callback;
+  #if defined(__linux__)
+    int wd = -1;
+  #elif defined(__APPLE__)
+    int dirFd = -1;
+    int fileFd = -1;
+  #endif
+  };
+  
+  // Callback collected under the mutex, invoked after releasing it
+  struct Dispatch {
+    uint32_t id;
+    FileWatcher::Callback callback;
+    std::string event;
+    std::string name;
+  };
+  
+  //
+  // Watcher thread and the watches. Callbacks are invoked without the mutex,
+  // they may block (e.g. on a full next frame queue) while the script thread adds or removes watches
+  struct WatcherState {
+    std::mutex mutex;
+    std::thread thread;
+    std::map<uint32_t, Watch> watches;
+    uint32_t nextId = 1;
+    int wakeFds[2] = { -1, -1 };
+  #if defined(__linux__)
+    int inotifyFd = -1;
+    std::map<int, int> wdRefs;
+  #elif defined(__APPLE__)
+    int kq = -1;
+  #endif
+    
+    ~WatcherState(){
+      if(thread.joinable()){
+        char quit = 1;
+        ssize_t written = write(wakeFds[1], &quit, 1);
+        (void)written;
+        thread.join();
+      }
+      for(int fd : wakeFds){
+        if(fd >= 0) close(fd);
+      }
+    #if defined(__linux__)
+      if(inotifyFd >= 0) close(inotifyFd);
+    #elif defined(__APPLE__)
+      for(auto& it : watches){
+        if(it.second.dirFd >= 0) close(it.second.dirFd);
+        if(it.second.fileFd >= 0) close(it.second.fileFd);
+      }
+      if(kq >= 0) close(kq);
+    #endif
+    }
+  };
+  
+  WatcherState& state(){
+    static WatcherState sState;
+    return sState;
+  }
+  
+  // Watcher thread, skips watches removed since the callbacks were collected
+  void dispatch( WatcherState& s, std::vector<Dispatch>& pending ){
+    for(Dispatch& entry : pending){
+      {
+        std::lock_guard<std::mutex> lck( s.mutex );
+        if(s.watches.find(entry.id) == s.watches.end()) continue;
+      }
+      entry.callback(entry.event, entry.name);
+    }
+    pending.clear();
+  }
+  
+#if defined(__linux__)
+  
+  const uint32_t kWatchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+  const uint32_t kChangeMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB;
+  
+  void watcherThreadFn(){
+    WatcherState& s = state();
+    alignas(struct inotify_event) char buffer[4096];
+    std::vector<Dispatch> pending;
+    
+    while( true ) {
+      struct pollfd fds[2] = { { s.inotifyFd, POLLIN, 0 }, { s.wakeFds[0], POLLIN, 0 } };
+      if(poll(fds, 2, -1) < 0){
+        if(errno == EINTR) continue;
+        break;
+      }
+      if(fds[1].revents) break;
+      
+      ssize_t length = read(s.inotifyFd, buffer, sizeof(buffer));
+      if(length <= 0) continue;
+      
+      {
+        std::lock_guard<std::mutex> lck( s.mutex );
+        for(char* ptr = buffer; ptr < buffer + length; ){
+          const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+          ptr += sizeof(struct inotify_event) + event->len;
+          
+          std::string name = event->len ? event->name : "";
+          const char* type = (event->mask & kChangeMask) ? "change" : "rename";
+          
+          for(auto& it : s.watches){
+            Watch& watch = it.second;
+            if(watch.wd == event->wd && (watch.name.empty() || watch.name == name)){
+              pending.push_back({ it.first, watch.callback, type, name });
+            }
+          }
+        }
+      }
+      dispatch(s, pending);
+    }
+  }
+  
+  bool startWatch( WatcherState& s, Watch& watch, std::string* error ){
+    if(s.inotifyFd < 0){
+      s.inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+      if(s.inotifyFd < 0){
+        *error = strerror(errno);
+        return false;
+      }
+    }
+    
+    // The same directory yields the same descriptor, it is shared by reference count
+    watch.wd = inotify_add_watch(s.inotifyFd, watch.dir.c_str(), kWatchMask);
+    if(watch.wd < 0){
+      *error = strerror(errno);
+      return false;
+    }
+    s.wdRefs[watch.wd]++;
+    return true;
+  }
+  
+  void stopWatch( WatcherState& s, Watch& watch ){
+    if(--s.wdRefs[watch.wd] == 0){
+      s.wdRefs.erase(watch.wd);
+      inotify_rm_watch(s.inotifyFd, watch.wd);
+    }
+  }
+  
+#elif defined(__APPLE__)
+  
+  const uint32_t kVnodeFlags = NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME;
+  
+  // udata is the watch id shifted left, the low bit marks the file descriptor, 0 is the wake pipe
+  bool addVnode( WatcherState& s, int fd, uint32_t id, bool file ){
+    struct kevent change;
+    EV_SET(&change, fd, EVFILT_VNODE, EV_ADD | EV_CLEAR, kVnodeFlags, 0, (void*)(uintptr_t)((id << 1) | (file ? 1 : 0)));
+    return kevent(s.kq, &change, 1, nullptr, 0, nullptr) == 0;
+  }
+  
+  bool openFile( WatcherState& s, Watch& watch, uint32_t id ){
+    watch.fileFd = open((watch.dir + "/" + watch.name).c_str(), O_EVTONLY);
+    if(watch.fileFd >= 0 && !addVnode(s, watch.fileFd, id, true)){
+      close(watch.fileFd);
+      watch.fileFd = -1;
+    }
+    return watch.fileFd >= 0;
+  }
+  
+  void watcherThreadFn(){
+    WatcherState& s = state();
+    struct kevent events[16];
+    std::vector<Dispatch> pending;
+    
+    while( true ) {
+      int count = kevent(s.kq, nullptr, 0, events, 16, nullptr);
+      if(count < 0){
+        if(errno == EINTR) continue;
+        break;
+      }
+      
+      {
+        std::lock_guard<std::mutex> lck( s.mutex );
+        for(int i = 0; i < count; i++){
+          uintptr_t data = (uintptr_t)events[i].udata;
+          if(data == 0) return;
+          
+          auto it = s.watches.find((uint32_t)(data >> 1));
+          if(it == s.watches.end()) continue;
+          Watch& watch = it->second;
+          uint32_t id = it->first;
+          
+          if(data & 1){
+            // The file was replaced (atomic save) or deleted, follow the path to the new file
+            if(events[i].fflags & (NOTE_DELETE | NOTE_RENAME)){
+              close(watch.fileFd);
+              watch.fileFd = -1;
+              pending.push_back({ id, watch.callback, openFile(s, watch, id) ? "change" : "rename", watch.name });
+            } else {
+              pending.push_back({ id, watch.callback, "change", watch.name });
+            }
+          }
+          else if(watch.name.empty()){
+            pending.push_back({ id, watch.callback, "rename", "" });
+          }
+          // Directory entries changed, a deleted file may be back
+          else if(watch.fileFd < 0 && openFile(s, watch, id)){
+            pending.push_back({ id, watch.callback, "rename", watch.name });
+          }
+        }
+      }
+      dispatch(s, pending);
+    }
+  }
+  
+  bool startWatch( WatcherState& s, Watch& watch, uint32_t id, std::string* error ){
+    if(s.kq < 0){
+      s.kq = kqueue();
+      if(s.kq < 0){
+        *error = strerror(errno);
+        return false;
+      }
+      struct kevent change;
+      EV_SET(&change, s.wakeFds[0], EVFILT_READ, EV_ADD, 0, 0, nullptr);
+      kevent(s.kq, &change, 1, nullptr, 0, nullptr);
+    }
+    
+    watch.dirFd = open(watch.dir.c_str(), O_EVTONLY);
+    if(watch.dirFd < 0 || !addVnode(s, watch.dirFd, id, false)){
+      *error = strerror(errno);
+      if(watch.dirFd >= 0) close(watch.dirFd);
+      return false;
+    }
+    
+    if(!watch.name.empty() && !openFile(s, watch, id)){
+      *error = strerror(errno);
+      close(watch.dirFd);
+      return false;
+    }
+    return true;
+  }
+  
+  void stopWatch( WatcherState& s, Watch& watch ){
+    // Closing the descriptors drops their events
+    if(watch.fileFd >= 0) close(watch.fileFd);
+    close(watch.dirFd);
+  }
+  
+#endif
+  
+} // namespace
+
+uint32_t FileWatcher::add( const cinder::fs::path& path, Callback callback, std::string* error ){
+#if defined(__linux__) || defined(__APPLE__)
+  WatcherState& s = state();
+  std::lock_guard<std::mutex> lck( s.mutex );
+  
+  boost::system::error_code ec;
+  cinder::fs::path target = cinder::fs::canonical(path, ec);
+  if(ec){
+    *error = ec.message();
+    return 0;
+  }
+  
+  Watch watch;
+  watch.callback = callback;
+  if(cinder::fs::is_directory(target)){
+    watch.dir = target.string();
+  } else {
+    watch.dir = target.parent_path().string();
+    watch.name = target.filename().string();
+  }
+  
+  if(s.wakeFds[0] < 0 && pipe(s.wakeFds) != 0){
+    *error = strerror(errno);
+    return 0;
+  }
+  
+  uint32_t id = s.nextId++;
+#if defined(__linux__)
+  if(!startWatch(s, watch, error)) return 0;
+#else
+  if(!startWatch(s, watch, id, error)) return 0;
+#endif
+  s.watches[id] = watch;
+  
+  if(!s.thread.joinable()){
+    s.thread = std::thread(watcherThreadFn);
+  }
+  return id;
+#else
+  *error = "File watching is not supported on this platform";
+  return 0;
+#endif
+}
+
+void FileWatcher::remove( uint32_t id ){
+#if defined(__linux__) || defined(__APPLE__)
+  WatcherState& s = state();
+  std::lock_guard<std::mutex> lck( s.mutex );
+  
+  auto it = s.watches.find(id);
+  if(it == s.watches.end()) return;
+  
+  stopWatch(s, it->second);
+  s.watches.erase(it);
+#endif
+}
+
+} // namespace cjs
@@ -0,0 +1,58 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _FileWatcher_hpp_
+#define _FileWatcher_hpp_
+
+#pragma once
+
+#include <string>
+#include <functional>
+#include <stdint.h>
+
+#include "cinder/Filesystem.h"
+
+//
+// Native file system change notifications, inotify on Linux and kqueue on OS X.
+//
+// Files are watched through their parent directory as well, so editors that save by writing
+// a temporary file and renaming it over the original keep being tracked.
+// Events are "change" (contents or attributes) and "rename" (created, deleted or moved),
+// with the name of the affected entry; kqueue does not name entries changed in a watched directory.
+// Callbacks run on the single watcher thread without any lock held, they must not touch v8.
+
+namespace cjs {
+
+class FileWatcher {
+  public:
+  typedef std::function<void(const std::string& event, const std::string& filename)> Callback;
+  
+  // Watch id, 0 if the path can not be watched (error is set)
+  static uint32_t add( const cinder::fs::path& path, Callback callback, std::string* error );
+  
+  // No new events are dispatched for the id after remove returns, a callback that was
+  // already dispatched may still run once, so callbacks own whatever state they touch
+  static void remove( uint32_t id );
+};
+
+} // namespace cjs
+
+#endif
@@ -25,5 +25,29 @@
 namespace cjs {
 
 cinder::app::App* PipeModule::sApp = nullptr;
+cinder::ConcurrentCircularBuffer<NextFrameFn>* PipeModule::sExecutionQueue = nullptr;
+std::mutex PipeModule::sOverflowMutex;
+std::vector<NextFrameFn> PipeModule::sOverflow;
+std::atomic<bool> PipeModule::sOverflowing(false);
+cinder::gl::ContextRef PipeModule::sBackgroundContext;
+
+WorkerPool& PipeModule::getWorkerPool() {
+  static WorkerPool pool(2);
+  return pool;
+}
+
+WorkerPool& PipeModule::getGLWorker() {
+  static WorkerPool worker(1);
+  
+  if(!sBackgroundContext){
+    sBackgroundContext = cinder::gl::Context::create( cinder::gl::context() );
+    cinder::gl::ContextRef context = sBackgroundContext;
+    worker.submit([context](){
+      context->makeCurrent();
+    });
+  }
+  
+  return worker;
+}
 
 }
\ No newline at end of file
@@ -27,11 +27,29 @@
 #include "cinder/app/Event.h"
 
 #include "cinder/app/App.h"
+#include "cinder/ConcurrentCircularBuffer.h"
+#include "cinder/gl/Context.h"
 
 #include "v8.h"
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace cjs {
   
+  // Function to be called on the script thread with the next frame (execution queue entry)
+  class NextFrameFnHolder {
+    public:
+    v8::Persistent<v8::Function> v8Fn;
+    bool repeat = false;
+    
+    // Optional, called instead of v8Fn() to pass arguments (e.g. results of async work)
+    std::function<void(v8::Isolate* isolate, v8::Local<v8::Function> fn)> complete;
+  };
+  typedef std::shared_ptr<NextFrameFnHolder> NextFrameFn;
+  
   // TODO:
   // - provide base methods to register as callback for draw, mouse/key events etc. -> registerMouseMove() -> vector<PipeModule> _mouseMoveModules;
   // - force modules to have a name which they can be identified with
@@ -65,6 +83,39 @@ namespace cjs {
         return ctx;
       }
     
+      static void setExecutionQueue( cinder::ConcurrentCircularBuffer<NextFrameFn>* queue ) {
+        sExecutionQueue = queue;
+      }
+    
+      // Queue fn for the next frame, may be called from any thread and never blocks.
+      // Only the script thread drains the queue, so a blocking push from it (or from a worker
+      // while it waits on that worker) could never return. When the queue is full, entries go to
+      // an unbounded overflow list until the next frame takes them.
+      static void nextFrame( NextFrameFn fn ) {
+        if(!sOverflowing.load(std::memory_order_acquire) && sExecutionQueue->tryPushFront(fn)){
+          return;
+        }
+        std::lock_guard<std::mutex> lck( sOverflowMutex );
+        sOverflow.push_back(fn);
+        sOverflowing.store(true, std::memory_order_release);
+      }
+    
+      // Script thread, at frame start. Returns the number of entries to pop from the execution queue
+      // this frame and takes the overflow, which was queued after them and runs after them.
+      static size_t takeQueued( std::vector<NextFrameFn>* overflow ) {
+        std::lock_guard<std::mutex> lck( sOverflowMutex );
+        overflow->swap(sOverflow);
+        sOverflowing.store(false, std::memory_order_release);
+        return sExecutionQueue->getSize();
+      }
+    
+      // Shared pool for blocking work
+      static WorkerPool& getWorkerPool();
+    
+      // Single thread with a background GL context for uploads and shader compiles.
+      // The context is created on first call, sharing with the context current on the calling thread.
+      static WorkerPool& getGLWorker();
+    
       // Virtual Spec
       // TODO: rename loadGlobalJS to loadBindings
       virtual void loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) = 0;
@@ -74,6 +125,11 @@ namespace cjs {
       v8::Isolate* mIsolate;
       v8::Persistent<v8::Context>* ctx;
       static cinder::app::App* sApp;
+      static cinder::ConcurrentCircularBuffer<NextFrameFn>* sExecutionQueue;
+      static std::mutex sOverflowMutex;
+      static std::vector<NextFrameFn> sOverflow;
+      static std::atomic<bool> sOverflowing;
+      static cinder::gl::ContextRef sBackgroundContext;
   };
 }
 
@@ -27,9 +27,33 @@ using namespace std;
 
 namespace cjs {
   
-std::map<uint32_t, boost::any> StaticFactory::_sObjectMap;
-uint32_t StaticFactory::_sObjectCounter = 0;
+unsigned long StaticFactory::_sObjectCount = 0;
 FactoryStats StaticFactory::_stats;
 FactorySettings StaticFactory::_settings;
+v8::Persistent<v8::ObjectTemplate> StaticFactory::_sHandleTemplate;
+std::vector<StaticFactory::Slot> StaticFactory::_sSlots;
+std::vector<uint32_t> StaticFactory::_sFreeList;
+
+Local<Object> StaticFactory::newHandle( Isolate* isolate ){
+  EscapableHandleScope scope(isolate);
+  
+  if(_sHandleTemplate.IsEmpty()){
+    Local<ObjectTemplate> handleTemplate = ObjectTemplate::New(isolate);
+    handleTemplate->SetInternalFieldCount(1);
+    _sHandleTemplate.Reset(isolate, handleTemplate);
+  }
+  
+  Local<Object> handle = Local<ObjectTemplate>::New(isolate, _sHandleTemplate)->NewInstance();
+  handle->SetAlignedPointerInInternalField(0, nullptr);
+  
+  return scope.Escape(handle);
+}
+
+/**
+ * __handle__()
+ */
+void StaticFactory::createHandle( const v8::FunctionCallbackInfo<v8::Value>& args ){
+  args.GetReturnValue().Set(newHandle(args.GetIsolate()));
+}
   
 } // namespace
@@ -24,18 +24,30 @@
 
 #pragma once
 
-#include <map>
+#include <vector>
+#include <memory>
+#include <functional>
 #include <iostream>
 #include <assert.h>
 
-#include <boost/any.hpp>
-
 #include "v8.h"
 
 //
 // The factory manages the references between C and js.
 // Modules request objects from the factory and the factory takes care of cleanup
 
+// Ids handed to js pack a slot index and a generation:
+//   [ generation : 12 | index : 20 ]
+// All types share one slot table and free list, so an index belongs to a single object at a time.
+// A lookup is a bounds check, a generation compare and a type tag compare on the wrapper,
+// ids of another type (a texture id passed as a Vbo) resolve to an empty pointer like stale ids.
+// Removed slots are reused with a bumped generation, stale ids from js resolve to an empty
+// pointer instead of a recycled object. Id 0 is never handed out.
+//
+// Holders created from the handle template (__handle__() in js) additionally carry a pointer
+// to their wrapper in internal field 0. Natives can resolve those with get<T>(args[n]) without
+// reading the "id" property or touching the slot table. Plain objects and numeric ids still work.
+
 // TODO:
 //  - store per isolate/context (removable when module is unloaded)
 //  - Allow named "scope" creation to destroy everything within a scope after a run
@@ -55,13 +67,25 @@ namespace cjs {
   class StaticFactory {
     // TODO: (GC loop (with Timer)) GC finish callback to check for orphaned handles and remove its wraps
     
+    static const uint32_t kIndexBits = 20;
+    static const uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static const uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+    
+    // Type tag and id, shared by all wrappers so internal field pointers can be checked before casting
+    class WrapperBase {
+      public:
+      virtual ~WrapperBase(){}
+      
+      const void* type;
+      uint32_t id;
+      std::function<void()> onRemove;
+    };
+    
     //
-    // FIXME: Leaking memory
     // FIXME: Not thread safe
     template<class T>
-    class Wrapper {
+    class Wrapper : public WrapperBase {
       public:
-      uint32_t id;
       std::shared_ptr<T> value;
       
       ~Wrapper(){
@@ -70,7 +94,6 @@ namespace cjs {
           handle_.Reset();
         }
         handle_.Reset();
-        value.reset();
       }
       
       inline v8::Persistent<v8::Object>& persistent() {
@@ -104,12 +127,55 @@ namespace cjs {
       v8::Persistent<v8::Object> handle_;
     };
     
+    // Empty while the slot is on the free list
+    struct Slot {
+      uint32_t generation = 0;
+      std::unique_ptr<WrapperBase> wrap;
+    };
+    
+    template<class T>
+    struct TypeTag {
+      static const char tag;
+    };
+    
+    // Unique address per type, used as the wrapper type tag
+    template<class T>
+    static inline const void* typeTag(){
+      return &TypeTag<T>::tag;
+    }
+    
+    // Wrapper of a living id of type T, null for unknown, stale or foreign ids
+    template<class T>
+    static inline Wrapper<T>* lookup( uint32_t id ){
+      uint32_t index = id & kIndexMask;
+      if(index >= _sSlots.size()){
+        return nullptr;
+      }
+      const Slot& slot = _sSlots[index];
+      if(slot.generation != (id >> kIndexBits) || !slot.wrap || slot.wrap->type != typeTag<T>()){
+        return nullptr;
+      }
+      return static_cast<Wrapper<T>*>(slot.wrap.get());
+    }
+    
+    // Wrapper in internal field 0 if the holder was created from the handle template
+    static inline WrapperBase* unwrap( v8::Local<v8::Object> holder ){
+      if(holder->InternalFieldCount() < 1){
+        return nullptr;
+      }
+      return static_cast<WrapperBase*>(holder->GetAlignedPointerFromInternalField(0));
+    }
+    
     public:
     
       static void initialize( FactorySettings settings ){
         _settings = settings;
       };
     
+      // Holder object with an internal field for the wrapper pointer
+      static v8::Local<v8::Object> newHandle( v8::Isolate* isolate );
+      static void createHandle( const v8::FunctionCallbackInfo<v8::Value>& args );
+    
       template<class T>
       static void create( v8::Isolate* isolate, v8::Handle<v8::Object> idHolder ){
         put( isolate, std::shared_ptr<T>(new T()), idHolder );
@@ -117,70 +183,163 @@ namespace cjs {
     
       template<class T>
       static void put( v8::Isolate* isolate, std::shared_ptr<T> value, v8::Handle<v8::Object> idHolder ){
-        std::shared_ptr<Wrapper<T>> tuple( new Wrapper<T>() );
+        std::vector<Slot>& table = _sSlots;
+        std::vector<uint32_t>& freeList = _sFreeList;
         
-        // TODO: Replace with _getId()
-        uint32_t id = ++_sObjectCounter;
-        tuple->id = id;
-        tuple->value = value;
-
-        idHolder->Set(v8::String::NewFromUtf8(isolate, "id"), v8::Uint32::New(isolate, id));
+        uint32_t index;
+        if(!freeList.empty()){
+          index = freeList.back();
+          freeList.pop_back();
+        } else {
+          if(table.size() > kIndexMask){
+            std::cout << "Could not insert into factory, out of slots." << std::endl;
+            return;
+          }
+          if(table.empty()){
+            table.reserve(_settings.maxObjects);
+          }
+          index = (uint32_t)table.size();
+          table.emplace_back();
+        }
         
-        tuple->Wrap(idHolder);
+        Slot& slot = table[index];
         
-        // Store
-        std::pair<uint32_t, boost::any> pair(id, tuple);
-        if(_sObjectMap.insert(pair).second == false){
-          std::cout << "Could not insert into _sObjectMap." << std::endl;
-          pair.second.clear();
-          tuple.reset();
-          return;
+        // Generation 0 is skipped, so no id is ever 0
+        slot.generation = (slot.generation + 1) & kGenerationMask;
+        if(slot.generation == 0){
+          slot.generation = 1;
         }
         
+        uint32_t id = (slot.generation << kIndexBits) | index;
+        Wrapper<T>* wrap = new Wrapper<T>();
+        wrap->type = typeTag<T>();
+        wrap->id = id;
+        wrap->value = value;
+        slot.wrap.reset(wrap);
+
+        idHolder->Set(v8::String::NewFromUtf8(isolate, "id"), v8::Uint32::New(isolate, id));
+        if(idHolder->InternalFieldCount() > 0){
+          idHolder->SetAlignedPointerInInternalField(0, wrap);
+        }
+        
+        wrap->Wrap(idHolder);
+        
         // stats
         _stats.puts++;
+        _sObjectCount++;
         
         // Todo: check if needed
-        isolate->AdjustAmountOfExternalAllocatedMemory(sizeof(*tuple));
+        isolate->AdjustAmountOfExternalAllocatedMemory(sizeof(Wrapper<T>));
         
       }
     
       template<class T>
-      static std::shared_ptr<T> get( uint32_t id ){
-        boost::any wrap = _sObjectMap[id];
-        if(wrap.empty()){
+      static inline std::shared_ptr<T> get( uint32_t id ){
+        // Unknown, stale (removed and reused slot) or foreign ids resolve to empty
+        Wrapper<T>* wrap = lookup<T>(id);
+        if(!wrap){
           return std::shared_ptr<T>();
-        } else {
-          // If conversion fails, the ids are probably mixed up
-          // and the map returns the wrong object so it cannot be converted to T
-          // (Or the type requested just doesn't match the type stored...)
-          std::shared_ptr<Wrapper<T>> proxy = boost::any_cast<std::shared_ptr<Wrapper<T>>>(wrap);
-          return proxy->value;
         }
+        return wrap->value;
+      }
+    
+      // Resolves a handle object (internal field or "id" property) or a numeric id
+      template<class T>
+      static inline std::shared_ptr<T> get( v8::Local<v8::Value> handle ){
+        if(handle->IsObject()){
+          v8::Local<v8::Object> holder = handle.As<v8::Object>();
+          if(holder->InternalFieldCount() > 0){
+            WrapperBase* wrap = unwrap(holder);
+            if(!wrap || wrap->type != typeTag<T>()){
+              return std::shared_ptr<T>();
+            }
+            return static_cast<Wrapper<T>*>(wrap)->value;
+          }
+          return get<T>(holder->Get(v8::String::NewFromUtf8(v8::Isolate::GetCurrent(), "id"))->Uint32Value());
+        }
+        return get<T>(handle->Uint32Value());
       }
     
+      // Swaps the object behind a living id, the id and its holder in js stay the same.
+      // False for unknown or stale ids.
+      template<class T>
+      static bool replace( uint32_t id, std::shared_ptr<T> value ){
+        Wrapper<T>* wrap = lookup<T>(id);
+        if(!wrap){
+          return false;
+        }
+        wrap->value = value;
+        return true;
+      }
+
+      // Called once when the id goes away, through remove() or when its holder was collected.
+      // False for unknown or stale ids.
+      template<class T>
+      static bool onRemove( uint32_t id, std::function<void()> fn ){
+        Wrapper<T>* wrap = lookup<T>(id);
+        if(!wrap){
+          return false;
+        }
+        wrap->onRemove = fn;
+        return true;
+      }
+
       template<class T>
       static void remove( v8::Isolate* isolate, uint32_t id ){
+        Wrapper<T>* wrap = lookup<T>(id);
+        if(!wrap){
+          return;
+        }
         
-        boost::any wrap = _sObjectMap[id];
-        if(!wrap.empty()){
-          v8::HandleScope scope(isolate);
-          std::shared_ptr<Wrapper<T>> proxy = boost::any_cast<std::shared_ptr<Wrapper<T>>>(wrap);
-
-          isolate->AdjustAmountOfExternalAllocatedMemory(-sizeof(*proxy));
-          _sObjectMap.erase(id);
-          proxy.reset();
-          
-          // stats
-          _stats.removes++;
+        v8::HandleScope scope(isolate);
+        Slot& slot = _sSlots[id & kIndexMask];
         
+        // Detach from a still living holder, so it can not reach the deleted wrapper
+        if(!wrap->persistent().IsEmpty()){
+          v8::Local<v8::Object> holder = v8::Local<v8::Object>::New(isolate, wrap->persistent());
+          if(holder->InternalFieldCount() > 0){
+            holder->SetAlignedPointerInInternalField(0, nullptr);
+          }
         }
-        // Todo: release id for re-use
         
+        isolate->AdjustAmountOfExternalAllocatedMemory(-sizeof(Wrapper<T>));
+        
+        // Run after the slot is free, the hook may look the id up or remove other objects
+        std::function<void()> onRemove = std::move(wrap->onRemove);
+        
+        // Bump the generation right away, the id stays invalid until the slot is reused
+        slot.generation = (slot.generation + 1) & kGenerationMask;
+        slot.wrap.reset();
+        _sFreeList.push_back(id & kIndexMask);
+        
+        // stats
+        _stats.removes++;
+        _sObjectCount--;
+        
+        if(onRemove){
+          onRemove();
+        }
+      }
+    
+      template<class T>
+      static void remove( v8::Isolate* isolate, v8::Local<v8::Value> handle ){
+        if(handle->IsObject()){
+          v8::Local<v8::Object> holder = handle.As<v8::Object>();
+          if(holder->InternalFieldCount() > 0){
+            WrapperBase* wrap = unwrap(holder);
+            if(wrap && wrap->type == typeTag<T>()){
+              remove<T>(isolate, wrap->id);
+            }
+            return;
+          }
+          remove<T>(isolate, holder->Get(v8::String::NewFromUtf8(isolate, "id"))->Uint32Value());
+          return;
+        }
+        remove<T>(isolate, handle->Uint32Value());
       }
     
       static unsigned long size(){
-        return _sObjectMap.size();
+        return _sObjectCount;
       }
     
       static FactoryStats& getStats(){
@@ -188,14 +347,17 @@ namespace cjs {
       }
     
     private:
-      // TODO: Improve counters and reuse unused ids (generate ids at startup)
-      //       -> If id space is limited, it would help to spot leaks in JS scripts
-      static std::map<uint32_t, boost::any> _sObjectMap;
-      static uint32_t _sObjectCounter;
+      static unsigned long _sObjectCount;
       static FactorySettings _settings;
       static FactoryStats _stats;
+      static v8::Persistent<v8::ObjectTemplate> _sHandleTemplate;
+      static std::vector<Slot> _sSlots;
+      static std::vector<uint32_t> _sFreeList;
   };
   
+  template<class T>
+  const char StaticFactory::TypeTag<T>::tag = 0;
+  
 } // namespace
 
 #endif
\ No newline at end of file
@@ -10,233 +10,191 @@
 #define __cinderjs__Timer__
 
 #include <chrono>
-#include <thread>
+#include <memory>
+#include <mutex>
 #include <functional>
+#include <queue>
+#include <vector>
+#include <unordered_map>
 #include <string.h>
-#include <boost/bind.hpp>
 #include <boost/any.hpp>
-#include "cinder/Timer.h"
-#include "cinder/ConcurrentCircularBuffer.h"
 #include "v8.h"
 
 namespace cjs {
 
+//
+// Min-heap of due times, set/clear are O(log n) / O(1).
+// Cleared or rescheduled timers leave stale heap entries, which are skipped when they come up.
+//
+// There is no timer thread, the owner calls dispatch() (e.g. once per frame)
+// and due callbacks run on the calling thread in deadline order.
 class Timer {
 
+  public:
+  typedef std::chrono::steady_clock Clock;
+  
+  private:
+
   class TimerFnHolder {
     public:
     uint32_t id;
-    double after;
-    double scheduledAt;
+    Clock::duration after;
+    Clock::time_point due;
     std::function<void(boost::any passOn)> fn;
     bool _repeat = false;
-    bool _remove = false;
     boost::any passOn;
   };
   typedef std::shared_ptr<TimerFnHolder> TimerFn;
   
-  // Used to cancel a waiting thread after timeout if not needed anymore.
-  // Maybe there is a better way to interrupt the waiting thread.
-  class WaitInfo {
-    public:
-    double waitFor;
-    bool canceled = false;
+  struct HeapEntry {
+    Clock::time_point due;
+    uint32_t id;
+    
+    bool operator>( const HeapEntry& other ) const {
+      return due > other.due;
+    }
   };
   
   public:
-    Timer() : _timerQueue(1024) {
-      _scheduleTimer = new cinder::Timer(true);
-      _timerThread = std::make_shared<std::thread>( boost::bind( &Timer::_timerThreadFn, this) );
-    }
-    ~Timer(){
-      mShouldQuit = true;
-      
-      _timerRun = true;
-      cvTimerThread.notify_one();
-    
-      _timerQueue.cancel();
-      
-      // Shutdown Timer Thread
-      if( _timerThread ) {
-        _timerThread->join();
-        _timerThread.reset();
-      }
-      
-      if( waitThread ){
-        waitThread->join();
-        waitThread.reset();
-      }
-    }
+    Timer(){}
+    ~Timer(){}
   
     int set( int timeout, std::function<void(boost::any passOn)> callback, bool repeat, boost::any passOn);
     void clear( uint32_t id );
+    int dispatch( Clock::time_point now, Clock::duration budget );
   
   private:
     std::mutex _mutex;
-    std::shared_ptr<std::thread> _timerThread;
-    std::condition_variable cvTimerThread;
-    volatile bool _timerRun = false;
-    cinder::ConcurrentCircularBuffer<TimerFn> _timerQueue;
-    cinder::Timer _scheduleTimer;
-    double now;
-    std::map<uint32_t, TimerFn> mTimerFns;
-    double mNextScheduledTime = 0;
-    std::shared_ptr<std::thread> waitThread;
-    std::shared_ptr<WaitInfo> currentWaitInfo;
-    std::vector<uint32_t> markedForDeletion;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> mHeap;
+    std::unordered_map<uint32_t, TimerFn> mTimerFns;
   
     uint32_t _idCounter = 0;
   
-    void _timerThreadFn();
-    void _tick();
-    void _timerWaitingThreadFn( std::shared_ptr<WaitInfo> waitInfo );
-  
-    bool mShouldQuit = false;
+    void _compact();
+    TimerFn _popDue( Clock::time_point now, Clock::time_point* nextDue );
 };
   
 /**
  * Set a new timer
- * The callback function will be called after the given timeout
+ * The callback function will be called by the first dispatch() after the given timeout
  * @return int timer id (with which a timer can be canceled as well)
- * TODO: make timeout cancelable
  */
 int Timer::set( int timeout, std::function<void(boost::any passOn)> callback, bool repeat, boost::any passOn ) {
   TimerFn newTimeout(new TimerFnHolder());
   
-  newTimeout->id = _idCounter++;
-  newTimeout->after = timeout;
-  newTimeout->scheduledAt = _scheduleTimer.getSeconds() * 1000 + timeout;
+  newTimeout->after = std::chrono::milliseconds(timeout < 1 ? 1 : timeout);
+  newTimeout->due = Clock::now() + newTimeout->after;
   newTimeout->_repeat = repeat;
   newTimeout->fn = callback;
   newTimeout->passOn = passOn;
   
-  _timerQueue.pushFront(newTimeout);
-  
-  _timerRun = true;
-  cvTimerThread.notify_one();
+  std::lock_guard<std::mutex> lck( _mutex );
+  newTimeout->id = _idCounter++;
+  mTimerFns[newTimeout->id] = newTimeout;
+  mHeap.push({ newTimeout->due, newTimeout->id });
   
   return newTimeout->id;
 }
 
 /**
- *
+ * Removes the timer, its heap entry is dropped lazily
  */
 void Timer::clear( uint32_t id ) {
-  TimerFn clearTimeout(new TimerFnHolder());
-  
-  clearTimeout->id = id;
-  clearTimeout->_remove = true;
-  _timerQueue.pushFront(clearTimeout);
-  
-  _timerRun = true;
-  cvTimerThread.notify_one();
+  std::lock_guard<std::mutex> lck( _mutex );
+  mTimerFns.erase(id);
+  _compact();
 }
 
 /**
- *
+ * Rebuild the heap when stale entries (cleared timers) dominate it. Expects the lock to be held.
  */
-void Timer::_timerWaitingThreadFn( std::shared_ptr<WaitInfo> info ){
-  cinder::ThreadSetup threadSetup;
-  
-  if(info->waitFor > 1){
-    std::this_thread::sleep_for(std::chrono::milliseconds((long)info->waitFor));
+void Timer::_compact(){
+  if(mHeap.size() < 64 || mHeap.size() < mTimerFns.size() * 2){
+    return;
   }
   
-  if(!info->canceled){
-    _timerRun = true;
-    cvTimerThread.notify_one();
-    return;
+  std::vector<HeapEntry> entries;
+  entries.reserve(mTimerFns.size());
+  for( auto it = mTimerFns.begin(); it != mTimerFns.end(); it++ ) {
+    entries.push_back({ it->second->due, it->first });
   }
+  mHeap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>>(std::greater<HeapEntry>(), std::move(entries));
 }
 
 /**
- *
+ * Takes the earliest timer due at `now` off the heap and reschedules it if repeating.
+ * Returns an empty pointer if nothing is due, nextDue is then set to the earliest deadline (or max).
+ * Expects the lock to be held.
  */
-void Timer::_tick(){
-  if(waitThread){
-    // TODO: Better way to interrupt waiting thread?
-    currentWaitInfo->canceled = true;
-    waitThread->detach();
-    waitThread.reset();
-  }
-  
-  while(_timerQueue.isNotEmpty()){
-    TimerFn queuedTimeout;
-    _timerQueue.popBack(&queuedTimeout);
+Timer::TimerFn Timer::_popDue( Clock::time_point now, Clock::time_point* nextDue ){
+  while(!mHeap.empty()){
+    HeapEntry next = mHeap.top();
     
-    if(queuedTimeout->_remove){
-      mTimerFns.erase(queuedTimeout->id);
+    // Cleared, or a stale entry of a repeating timer
+    auto it = mTimerFns.find(next.id);
+    if(it == mTimerFns.end() || it->second->due != next.due){
+      mHeap.pop();
       continue;
     }
     
-    mTimerFns[queuedTimeout->id] = queuedTimeout;
-  }
-  
-  if(!mTimerFns.empty() && !mShouldQuit){
+    if(now < next.due){
+      *nextDue = next.due;
+      return TimerFn();
+    }
     
-    mNextScheduledTime = 0;
+    mHeap.pop();
+    TimerFn timer = it->second;
     
-    for( std::map<uint32_t, TimerFn>::iterator it = mTimerFns.begin(); it != mTimerFns.end(); it++ ) {
-      now = _scheduleTimer.getSeconds() * 1000;
-
-      if(it->second->scheduledAt - 1 <= now){
-        // Execute Timeout Callback
-        it->second->fn(it->second->passOn);
-       
-        // Repeat or delete?
-        if(it->second->_repeat){
-          it->second->scheduledAt = now + it->second->after - 1;
-        } else {
-          markedForDeletion.push_back(it->first);
-          continue;
-        }
-      }
+    // Repeat or delete?
+    if(timer->_repeat){
+      timer->due = next.due + timer->after;
       
-      if(it->second->scheduledAt < mNextScheduledTime || mNextScheduledTime == 0){
-        mNextScheduledTime = it->second->scheduledAt;
+      // Do not try to catch up on missed intervals
+      if(timer->due < now){
+        timer->due = now + timer->after;
       }
+      mHeap.push({ timer->due, timer->id });
+    } else {
+      mTimerFns.erase(it);
     }
     
-    // do deletion...
-    for( std::vector<uint32_t>::iterator it = markedForDeletion.begin(); it != markedForDeletion.end(); it++ ) {
-      mTimerFns.erase(*it);
-    }
-    markedForDeletion.clear();
-    
-    if(mTimerFns.empty()) {
-      return;
-    }
-    
-    // wait...
-    double waitFor = mNextScheduledTime - now - 1;
-    if(waitFor <= 0){
-      waitFor = 1;
-    }
-    currentWaitInfo = std::shared_ptr<WaitInfo>(new WaitInfo());
-    currentWaitInfo->waitFor = waitFor;
-    waitThread = std::make_shared<std::thread>( boost::bind( &Timer::_timerWaitingThreadFn, this, currentWaitInfo ) );
-    
+    return timer;
   }
+  
+  *nextDue = Clock::time_point::max();
+  return TimerFn();
 }
 
 /**
- * Timer thread
+ * Runs timers due at `now` in deadline order on the calling thread.
+ * Stops when the budget is used up (at least one runs), the rest stay due for the next call.
+ * @return int number of callbacks run
  */
-void Timer::_timerThreadFn(){
-  cinder::ThreadSetup threadSetup;
+int Timer::dispatch( Clock::time_point now, Clock::duration budget ){
+  Clock::time_point start = Clock::now();
+  Clock::time_point nextDue;
+  int count = 0;
+  
+  std::unique_lock<std::mutex> lck( _mutex );
   
-  // Thread loop
-  while( !mShouldQuit ) {
-    std::unique_lock<std::mutex> lck( _mutex );
-    cvTimerThread.wait(lck, [this]{ return _timerRun; });
+  while( true ) {
+    TimerFn timer = _popDue(now, &nextDue);
+    if(!timer) break;
     
-    _tick();
+    // Execute Timeout Callback without holding the lock, it may set/clear timers
+    lck.unlock();
+    timer->fn(timer->passOn);
+    count++;
     
-    _timerRun = false;
+    if(Clock::now() - start >= budget){
+      break;
+    }
+    lck.lock();
   }
+  
+  return count;
 }
 
-
 } // end namespace cjs
 
 #endif /* defined(__cinderjs__Timer__) */
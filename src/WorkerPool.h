@@ -0,0 +1,81 @@
+//
+//  WorkerPool.h
+//  cinderjs
+//
+//  Small fixed pool of threads for blocking work (file I/O, decoding) off the v8 thread.
+//  Jobs run in submission order, completions are handed back to js through the
+//  execution queue (PipeModule::nextFrame), jobs never touch v8 themselves.
+//
+
+#ifndef __cinderjs__WorkerPool__
+#define __cinderjs__WorkerPool__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include "cinder/Thread.h"
+
+namespace cjs {
+
+class WorkerPool {
+  public:
+  typedef std::function<void()> Job;
+
+  WorkerPool( size_t numThreads ) {
+    for(size_t i = 0; i < numThreads; i++){
+      mThreads.push_back(std::thread(&WorkerPool::_workerThreadFn, this));
+    }
+  }
+
+  ~WorkerPool(){
+    {
+      std::lock_guard<std::mutex> lck( _mutex );
+      mShouldQuit = true;
+    }
+    cvWorkers.notify_all();
+
+    // Queued jobs that did not start yet are dropped
+    for(std::thread& thread : mThreads){
+      thread.join();
+    }
+  }
+
+  void submit( Job job ) {
+    {
+      std::lock_guard<std::mutex> lck( _mutex );
+      mJobs.push_back(std::move(job));
+    }
+    cvWorkers.notify_one();
+  }
+
+  private:
+  void _workerThreadFn(){
+    cinder::ThreadSetup threadSetup;
+
+    std::unique_lock<std::mutex> lck( _mutex );
+    while( true ) {
+      cvWorkers.wait(lck, [this]{ return mShouldQuit || !mJobs.empty(); });
+      if(mShouldQuit) break;
+
+      Job job = std::move(mJobs.front());
+      mJobs.pop_front();
+
+      lck.unlock();
+      job();
+      lck.lock();
+    }
+  }
+
+  std::mutex _mutex;
+  std::condition_variable cvWorkers;
+  std::deque<Job> mJobs;
+  std::vector<std::thread> mThreads;
+  bool mShouldQuit = false;
+};
+
+} // namespace cjs
+
+#endif /* defined(__cinderjs__WorkerPool__) */
@@ -1,6 +1,7 @@
 #include "cinderjsApp.hpp"
 #include "ArrayBufferAllocator.h"
 #include "cinder/app/RendererGl.h"
+#include "cinder/Utilities.h"
 
 #include <boost/bind.hpp>
 #include <boost/thread/thread.hpp>
@@ -33,6 +34,7 @@
 #include "modules/vbo.hpp"
 #include "modules/vao.hpp"
 #include "modules/color.hpp"
+#include "modules/atlas.hpp"
 
 #include <assert.h>
 
@@ -57,11 +59,17 @@ bool CinderjsApp::sQuitRequested = false;
 bool CinderAppBase::shutdownInProgress = false;
 
 v8::Persistent<v8::Object> CinderjsApp::sModuleCache;
+v8::Persistent<v8::Function> CinderjsApp::sNativeWrap;
+v8::Persistent<v8::Function> CinderjsApp::sNativeRequire;
+const int CinderjsApp::sCinderNativeIndex = findNative("cinder");
 v8::Persistent<v8::Array> CinderjsApp::sModuleList;
   
 v8::Persistent<v8::Function> CinderjsApp::sDrawCallback;
 v8::Local<v8::Function> CinderjsApp::_fnDrawCallback;
 v8::Persistent<v8::Function> CinderjsApp::sEventCallback;
+bool CinderjsApp::sEventBatched = false;
+v8::Persistent<v8::Int32Array> CinderjsApp::sEventInts;
+v8::Persistent<v8::Float64Array> CinderjsApp::sEventFloats;
 
 v8::Persistent<v8::Object> CinderjsApp::sEmptyObject;
 
@@ -70,6 +78,8 @@ ConcurrentCircularBuffer<NextFrameFn> CinderjsApp::sExecutionQueue(1024);
 Timer CinderjsApp::_mainTimer;
 std::function<void(boost::any passOn)> CinderjsApp::_timerCallback;
 
+std::atomic<int> CinderjsApp::sPipelineLatency(0);
+
 int CinderjsApp::sGCRuns = 0;
 void CinderjsApp::gcPrologueCb(Isolate *isolate, GCType type, GCCallbackFlags flags) {
   sGCRuns++;
@@ -96,7 +106,7 @@ void CinderjsApp::handleV8TryCatch( v8::TryCatch &tryCatch, std::string info ) {
   #ifdef DEBUG
   std::cout << ex << std::endl;
   #endif
-  AppConsole::log( ex );
+  AppConsole::log( ex, LOG_ERROR );
 }
 
 
@@ -114,9 +124,11 @@ void CinderjsApp::cleanup()
   _eventRun = true;
   cvEventThread.notify_all();
   
-  mEventQueue.cancel();
   sExecutionQueue.cancel();
   
+  // Shutdown v8ScriptThread (pipelined mode)
+  stopPipeline();
+  
   // Shutdown v8EventThread
   if( mV8EventThread ) {
     mV8EventThread->join();
@@ -147,10 +159,17 @@ void CinderjsApp::setup()
   // Check argv arguments
   // TODO: Check for debug flag
   int pos = 0;
+  bool useCodeCache = true;
   for(std::vector<std::string>::iterator it = args.begin(); it != args.end(); ++it) {
+    if(*it == "--no-code-cache") useCodeCache = false;
     pos++;
   }
   
+  // Compiled natives and user modules are cached across launches
+  if(useCodeCache){
+    CodeCache::setDirectory(getHomeDirectory() / "Library" / "Caches" / "cinderjs");
+  }
+  
   // clear out the window with black
   gl::clear( Color( 0, 0, 0 ) );
   
@@ -170,7 +189,8 @@ void CinderjsApp::setup()
 /**
  * Runs a JS string and prints eventual errors to the AppConsole
  */
-v8::Local<v8::Value> CinderjsApp::executeScriptString( std::string scriptStr, Isolate* isolate, v8::Local<v8::Context> context, Handle<String> filename ){
+v8::Local<v8::Value> CinderjsApp::executeScriptString( std::string scriptStr, Isolate* isolate, v8::Local<v8::Context> context,
+  Handle<String> filename, std::string cacheKey ){
   EscapableHandleScope scope(isolate);
 
   v8::TryCatch try_catch;
@@ -181,8 +201,19 @@ v8::Local<v8::Value> CinderjsApp::executeScriptString( std::string scriptStr, Is
   // Create a string containing the JavaScript source code.
   Local<String> source = String::NewFromUtf8( isolate, scriptStr.c_str() );
   
-  // Compile the source code.
-  Local<Script> script = Script::Compile( source, filename );
+  // Compile the source code, through the code cache if a key was given
+  Local<Script> script;
+  if(cacheKey.empty()){
+    script = Script::Compile( source, filename );
+  } else {
+    script = CodeCache::compile( isolate, source, filename, CodeCache::NATIVE, cacheKey );
+  }
+  
+  if(script.IsEmpty()){
+    String::Utf8Value str(filename);
+    handleV8TryCatch(try_catch, "executeScriptString/" + std::string(*str));
+    return scope.Escape(Local<Value>());
+  }
   
   // Run the script to get the result.
   Local<Value> result = script->Run();
@@ -216,10 +247,14 @@ void CinderjsApp::v8Setup( std::string mainJS ){
   
   //mIsolate->AddGCPrologueCallback(gcPrologueCb);
   
-  // Setup timer callback
+  // Setup timer callback, runs from _mainTimer.dispatch() within v8Script
   _timerCallback = [=](boost::any passOn){
     NextFrameFn next = boost::any_cast<NextFrameFn>(passOn);
-    sExecutionQueue.pushFront(next);
+    v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(mIsolate, next->v8Fn);
+    if(!next->repeat){
+      next->v8Fn.Reset(); // Get rid of persistent
+    }
+    callback->Call(callback->CreationContext()->Global(), 0, nullptr);
   };
   
   // Create a stack-allocated handle scope.
@@ -233,9 +268,15 @@ void CinderjsApp::v8Setup( std::string mainJS ){
   mGlobal->Set(v8::String::NewFromUtf8(mIsolate, "toggleV8Stats"), v8::FunctionTemplate::New(mIsolate, toggleV8Stats));
   mGlobal->Set(v8::String::NewFromUtf8(mIsolate, "quit"), v8::FunctionTemplate::New(mIsolate, requestQuit));
   
+  // Native object handles (internal field holders, see StaticFactory)
+  mGlobal->Set(v8::String::NewFromUtf8(mIsolate, "__handle__"), v8::FunctionTemplate::New(mIsolate, StaticFactory::createHandle));
+  
   // Timer
   mGlobal->Set(v8::String::NewFromUtf8(mIsolate, "setTimer"), v8::FunctionTemplate::New(mIsolate, setTimer));
   
+  // Pipelining
+  mGlobal->Set(v8::String::NewFromUtf8(mIsolate, "__pipeline__"), v8::FunctionTemplate::New(mIsolate, setPipelined));
+  
   // Setup process object
   v8::Local<v8::ObjectTemplate> processObj = ObjectTemplate::New();
   processObj->Set(v8::String::NewFromUtf8(mIsolate, "nextFrame"), v8::FunctionTemplate::New(mIsolate, nextFrameJS));
@@ -258,6 +299,7 @@ void CinderjsApp::v8Setup( std::string mainJS ){
   
   //
   // Load Modules
+  PipeModule::setExecutionQueue(&sExecutionQueue);
   addModule(std::shared_ptr<AppModule>( new AppModule() ));
   addModule(std::shared_ptr<GLModule>( new GLModule() ));
   addModule(std::shared_ptr<ConsoleModule>( new ConsoleModule() ));
@@ -274,6 +316,7 @@ void CinderjsApp::v8Setup( std::string mainJS ){
   addModule(std::shared_ptr<VBOModule>( new VBOModule() ));
   addModule(std::shared_ptr<VAOModule>( new VAOModule() ));
   addModule(std::shared_ptr<ColorModule>( new ColorModule() ));
+  addModule(std::shared_ptr<AtlasModule>( new AtlasModule() ));
   
   
   // Create a new context.
@@ -330,10 +373,10 @@ void CinderjsApp::v8Setup( std::string mainJS ){
   
   // Execute entry script
   Local<Value> mainResult = executeScriptString( mainJS, mIsolate,
-    mMainContext, v8::String::NewFromUtf8(mIsolate, "cinder.js") );
+    mMainContext, v8::String::NewFromUtf8(mIsolate, "cinder.js"), "cinder" );
   
   // Call wrapper function with process object
-  if(mainResult->IsFunction()){
+  if(!mainResult.IsEmpty() && mainResult->IsFunction()){
     Local<Function> mainFn = mainResult.As<Function>();
     
     v8::TryCatch tryCatch;
@@ -364,10 +407,20 @@ void CinderjsApp::v8Setup( std::string mainJS ){
 /**
  *
  */
-v8::Handle<v8::Value> drawCallbackArgs[3];
 void CinderjsApp::v8Draw(){
+  v8Script(nullptr);
+  v8Overlay();
+}
+
+/**
+ * Runs the execution queue and the js draw callback.
+ * If record is given, gl.flush() command buffers are collected into it instead of being executed.
+ */
+v8::Handle<v8::Value> drawCallbackArgs[3];
+void CinderjsApp::v8Script( std::vector<float>* record ){
   
   // Gather some info...
+  Timer::Clock::time_point frameStart = Timer::Clock::now();
   double now = getElapsedSeconds() * 1000;
   double timePassed = now - lastFrameTime;
   lastFrameTime = now;
@@ -376,11 +429,19 @@ void CinderjsApp::v8Draw(){
     v8FPS = v8Frames;
     v8Frames = 0;
     mLastUpdate = now;
-    if(_v8StatsActive) mIsolate->GetHeapStatistics(&_mHeapStats);
+    if(_v8StatsActive){
+      v8::HeapStatistics heapStats;
+      mIsolate->GetHeapStatistics(&heapStats);
+      mHeapLimit = heapStats.heap_size_limit();
+      mHeapTotal = heapStats.total_heap_size();
+      mHeapUsed = heapStats.used_heap_size();
+    }
   }
 
   v8::Locker lock(mIsolate);
   
+  GLModule::setRecordTarget(record);
+  
   // JS Draw callback
   
   // Isolate
@@ -394,18 +455,34 @@ void CinderjsApp::v8Draw(){
     
   gl::pushMatrices();
 
-  // Handle execution queue
-  // TODO: Use a buffer queue and reuse event/frame buffer "packets" instead of instantiation at each creation time
-  while(sExecutionQueue.isNotEmpty()){
-    NextFrameFn nffn(new NextFrameFnHolder());
-    sExecutionQueue.popBack(&nffn);
+  // Handle execution queue, only what was queued before this frame, overflow entries last.
+  // Entries queued meanwhile (nextFrame from a nextFrame callback, async completions) wait for the next one.
+  auto runQueued = [this]( NextFrameFn& nffn ){
     v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(mIsolate, nffn->v8Fn);
     if(!nffn->repeat){
       nffn->v8Fn.Reset(); // Get rid of persistent
     }
-    v8::Handle<v8::Value> exArgv[0] = {};
-    callback->Call(callback->CreationContext()->Global(), 0, exArgv);
+    if(nffn->complete){
+      nffn->complete(mIsolate, callback);
+    } else {
+      v8::Handle<v8::Value> exArgv[0] = {};
+      callback->Call(callback->CreationContext()->Global(), 0, exArgv);
+    }
+  };
+  
+  NextFrameFn nffn;
+  size_t pending = PipeModule::takeQueued(&mOverflow);
+  while(pending-- > 0 && sExecutionQueue.tryPopBack(&nffn)){
+    runQueued(nffn);
   }
+  nffn.reset();
+  for(NextFrameFn& overflowed : mOverflow){
+    runQueued(overflowed);
+  }
+  mOverflow.clear();
+  
+  // Timers due at frame start, in deadline order, within the frame budget
+  _mainTimer.dispatch(frameStart, std::chrono::milliseconds(kTimerBudgetMs));
 
   if( !_fnDrawCallback.IsEmpty() ){
 
@@ -427,26 +504,64 @@ void CinderjsApp::v8Draw(){
     handleV8TryCatch(try_catch, "v8Draw");
   }
   
-  v8::Unlocker unlock(mIsolate);
+  GLModule::setRecordTarget(nullptr);
   
-  // FPS (TODO: if active)
-  cinder::TextLayout fpsText;
-  fpsText.setColor( cinder::ColorA( 1, 1, 1, 1 ) );
+  v8Frames++;
+}
+
+/**
+ * Replays the oldest completed script frame that was not shown yet (pipelined mode).
+ * If the script thread did not finish a new one in time, the last frame is shown again.
+ */
+void CinderjsApp::v8Replay(){
+  FrameCommands frame;
+  bool fresh = mFrameQueue->tryPopBack(&frame);
   
-  if(_fpsActive){
-    fpsText.addLine( "Ci FPS: " + std::to_string( cinder::app::App::getAverageFps() ) );
-    fpsText.addLine( "V8 FPS: " + std::to_string( v8FPS ) );
+  if(fresh){
+    if(mLastFrame){
+      mFramePool.tryPushFront(mLastFrame);
+    }
+    mLastFrame = frame;
   }
   
-  if(_v8StatsActive){
-    fpsText.addLine( "V8 Heap limit: " + std::to_string( _mHeapStats.heap_size_limit() ) );
-    fpsText.addLine( "V8 Heap total: " + std::to_string( _mHeapStats.total_heap_size() ) );
-    fpsText.addLine( "V8 Heap Used: " + std::to_string( _mHeapStats.used_heap_size() ) );
+  if(!mLastFrame) return;
+  
+  gl::pushMatrices();
+  
+  size_t errorAt = 0;
+  int error = GLModule::execute(mLastFrame->data(), mLastFrame->size(), &errorAt);
+  
+  gl::popMatrices();
+  
+  if(error && fresh){
+    AppConsole::log("Pipelined frame: " + std::string(error == 1 ? "truncated" : "unknown") + " command at float " + std::to_string(errorAt), LOG_ERROR);
   }
+}
+
+/**
+ *
+ */
+void CinderjsApp::v8Overlay(){
   
+  // FPS and heap stats
   if(_fpsActive || _v8StatsActive) {
+    std::string stats;
+    
+    if(_fpsActive){
+      stats += "Ci FPS: " + std::to_string( cinder::app::App::getAverageFps() ) + "\n";
+      stats += "V8 FPS: " + std::to_string( v8FPS.load() ) + "\n";
+    }
+    
+    if(_v8StatsActive){
+      stats += "V8 Heap limit: " + std::to_string( mHeapLimit.load() ) + "\n";
+      stats += "V8 Heap total: " + std::to_string( mHeapTotal.load() ) + "\n";
+      stats += "V8 Heap Used: " + std::to_string( mHeapUsed.load() ) + "\n";
+    }
+    stats.pop_back();
+    
     try {
-      cinder::gl::draw( cinder::gl::Texture::create( fpsText.render() ) );
+      mOverlayText.setText( stats );
+      mOverlayText.draw();
     } catch ( std::exception &e ){
       // don't draw if window not available
     }
@@ -464,8 +579,55 @@ void CinderjsApp::v8Draw(){
     }
   }
   
-  v8Frames++;
+}
+
+/**
+ * Script thread for pipelined mode, runs js one to two frames ahead of the render thread
+ */
+void CinderjsApp::v8ScriptThread( gl::ContextRef context ){
+  ThreadSetup threadSetup;
+  context->makeCurrent();
+  
+  while( !mShouldQuit && sPipelineLatency == mRunningLatency ) {
+    FrameCommands frame;
+    if(!mFramePool.tryPopBack(&frame)){
+      frame = std::make_shared<std::vector<float>>();
+    }
+    frame->clear();
+    
+    v8Script(frame.get());
+    
+    // Blocks while `latency` frames are waiting to be rendered (backpressure)
+    mFrameQueue->pushFront(frame);
+  }
+}
+
+/**
+ *
+ */
+void CinderjsApp::startPipeline(){
+  mRunningLatency = sPipelineLatency;
+  mFrameQueue.reset(new ConcurrentCircularBuffer<FrameCommands>(mRunningLatency));
+  
+  gl::ContextRef scriptCtx = gl::Context::create( gl::context() );
+  mV8ScriptThread = make_shared<std::thread>( boost::bind( &CinderjsApp::v8ScriptThread, this, scriptCtx ) );
   
+  AppConsole::log("Pipelined rendering with " + std::to_string(mRunningLatency) + " frame(s) latency.");
+}
+
+/**
+ *
+ */
+void CinderjsApp::stopPipeline(){
+  if( mV8ScriptThread ) {
+    // Unblocks a waiting pushFront, the thread exits on the latency/quit check
+    mFrameQueue->cancel();
+    mV8ScriptThread->join();
+    mV8ScriptThread.reset();
+  }
+  mFrameQueue.reset();
+  mLastFrame.reset();
+  mRunningLatency = 0;
 }
 
 /**
@@ -503,20 +665,74 @@ void CinderjsApp::v8EventThread( gl::ContextRef context ){
       Context::Scope ctxScope(context);
       context->Enter();
       
+      RawEvent evt;
+      
+      // Batch buffers, allocated once
+      int32_t* batchInts = nullptr;
+      double* batchFloats = nullptr;
+      int batchCount = 0;
+      
+      if(sEventBatched){
+        if(sEventInts.IsEmpty()){
+          Local<ArrayBuffer> intBuf = ArrayBuffer::New(mIsolate, kEventBatchSize * 4 * sizeof(int32_t));
+          Local<ArrayBuffer> floatBuf = ArrayBuffer::New(mIsolate, kEventBatchSize * 3 * sizeof(double));
+          sEventInts.Reset(mIsolate, Int32Array::New(intBuf, 0, kEventBatchSize * 4));
+          sEventFloats.Reset(mIsolate, Float64Array::New(floatBuf, 0, kEventBatchSize * 3));
+        }
+        batchInts = static_cast<int32_t*>(Local<Int32Array>::New(mIsolate, sEventInts)->Buffer()->GetContents().Data());
+        batchFloats = static_cast<double*>(Local<Float64Array>::New(mIsolate, sEventFloats)->Buffer()->GetContents().Data());
+      }
+      
+      auto deliverBatch = [&]( v8::Local<v8::Function> callback ){
+        if(batchCount == 0) return;
+        v8::Handle<v8::Value> argv[4] = {
+          v8::Number::New(mIsolate, CJS_EVENT_BATCH),
+          v8::Number::New(mIsolate, batchCount),
+          Local<Int32Array>::New(mIsolate, sEventInts),
+          Local<Float64Array>::New(mIsolate, sEventFloats)
+        };
+        batchCount = 0;
+        callback->Call(context->Global(), 4, argv);
+      };
       
       // TODO: do not treat events further if shutdown was requested (quit from js)
       // TODO: Get rid of if/else statements
-      while(mEventQueue.isNotEmpty()){
-        BufferedEvent evt(new BufferedEventHolder());
-        mEventQueue.popBack(&evt);
+      while(mEventQueue.pop(&evt, CJS_MOUSE_MOVE)){
         
         // Callback
         v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(mIsolate, sEventCallback);
         
         if(callback.IsEmpty()) continue;
         
+        // Batched: pack and deliver after the queue is drained (or the batch is full)
+        if(batchInts){
+          if(evt.type != CJS_FILE_DROP && evt.type != CJS_SHUTDOWN_REQUEST){
+            if(evt.type == CJS_RESIZE){
+              evt.x = getWindowWidth();
+              evt.y = getWindowHeight();
+            }
+            int32_t* ints = batchInts + batchCount * 4;
+            ints[0] = evt.type;
+            ints[1] = evt.code;
+            ints[2] = evt.charCode;
+            ints[3] = evt.modifiers;
+            double* floats = batchFloats + batchCount * 3;
+            floats[0] = evt.x;
+            floats[1] = evt.y;
+            floats[2] = evt.timestamp;
+            
+            if(++batchCount == kEventBatchSize){
+              deliverBatch(callback);
+            }
+            continue;
+          }
+          
+          // Keep ordering for events delivered on their own
+          deliverBatch(callback);
+        }
+        
         // Resize Event
-        if(evt->type == CJS_RESIZE){
+        if(evt.type == CJS_RESIZE){
           v8::Handle<v8::Value> argv[3] = {
             v8::Number::New(mIsolate, CJS_RESIZE),
             v8::Number::New(mIsolate, getWindowWidth()),
@@ -525,52 +741,42 @@ void CinderjsApp::v8EventThread( gl::ContextRef context ){
           callback->Call(context->Global(), 3, argv);
         }
         
-        // Mouse down
-        else if(evt->type == CJS_MOUSE_DOWN){
-          v8::Handle<v8::Value> argv[1] = {
-            v8::Number::New(mIsolate, CJS_MOUSE_DOWN)
-            // ... TODO: Push more event info
+        // Mouse down/up/move (moves are coalesced in the queue)
+        else if(evt.type == CJS_MOUSE_DOWN || evt.type == CJS_MOUSE_UP || evt.type == CJS_MOUSE_MOVE){
+          v8::Handle<v8::Value> argv[5] = {
+            v8::Number::New(mIsolate, evt.type),
+            v8::Number::New(mIsolate, evt.x),
+            v8::Number::New(mIsolate, evt.y),
+            v8::Number::New(mIsolate, evt.code),
+            v8::Number::New(mIsolate, evt.modifiers)
           };
-          callback->Call(context->Global(), 1, argv);
+          callback->Call(context->Global(), 5, argv);
         }
         
-        // Mouse up
-        else if(evt->type == CJS_MOUSE_UP){
-          v8::Handle<v8::Value> argv[1] = {
-            v8::Number::New(mIsolate, CJS_MOUSE_UP)
-            // ... TODO: Push more event info
+        // Key down/up
+        else if(evt.type == CJS_KEY_DOWN || evt.type == CJS_KEY_UP){
+          v8::Handle<v8::Value> argv[4] = {
+            v8::Number::New(mIsolate, evt.type),
+            v8::Number::New(mIsolate, evt.code),
+            v8::Number::New(mIsolate, evt.charCode),
+            v8::Number::New(mIsolate, evt.modifiers)
           };
-          callback->Call(context->Global(), 1, argv);
-        }
-        
-        // Key down
-        else if(evt->type == CJS_KEY_DOWN){
-          v8::Handle<v8::Value> argv[3] = {
-            v8::Number::New(mIsolate, CJS_KEY_DOWN),
-            v8::Number::New(mIsolate, evt->kEvt.getCode()),
-            v8::Number::New(mIsolate, evt->kEvt.getChar())
-            // ... TODO: Push more event info
-          };
-          callback->Call(context->Global(), 3, argv);
-        }
-        
-        // Key up
-        else if(evt->type == CJS_KEY_UP){
-          v8::Handle<v8::Value> argv[3] = {
-            v8::Number::New(mIsolate, CJS_KEY_UP),
-            v8::Number::New(mIsolate, evt->kEvt.getCode()),
-            v8::Number::New(mIsolate, evt->kEvt.getChar())
-            // ... TODO: Push more event info
-          };
-          callback->Call(context->Global(), 3, argv);
+          callback->Call(context->Global(), 4, argv);
         }
         
         // File Drop
-        else if(evt->type == CJS_FILE_DROP){
+        else if(evt.type == CJS_FILE_DROP){
+          std::vector<cinder::fs::path> dropped;
+          {
+            std::lock_guard<std::mutex> lck( mFileDropMutex );
+            if(mFileDrops.empty()) continue;
+            dropped.swap(mFileDrops.front());
+            mFileDrops.pop_front();
+          }
         
           Local<Array> files = Array::New(mIsolate);
-          for(int i = 0; i < evt->fdFiles.size(); i++){
-            files->Set(i, v8::String::NewFromUtf8(mIsolate, evt->fdFiles[i].c_str()));
+          for(int i = 0; i < dropped.size(); i++){
+            files->Set(i, v8::String::NewFromUtf8(mIsolate, dropped[i].c_str()));
           }
   
           v8::Handle<v8::Value> argv[2] = {
@@ -581,11 +787,16 @@ void CinderjsApp::v8EventThread( gl::ContextRef context ){
         }
         
         // Shutdown (gracefully)
-        else if(evt->type == CJS_SHUTDOWN_REQUEST){
+        else if(evt.type == CJS_SHUTDOWN_REQUEST){
           quit();
         }
       }
       
+      if(batchCount > 0){
+        v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(mIsolate, sEventCallback);
+        if(!callback.IsEmpty()) deliverBatch(callback);
+      }
+      
       context->Exit();
       v8::Unlocker unlock(mIsolate);
     }
@@ -603,14 +814,32 @@ void CinderjsApp::v8EventThread( gl::ContextRef context ){
  */
 void CinderjsApp::fileDrop( FileDropEvent event )
 {
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_FILE_DROP;
-  evt->fdFiles = event.getFiles();
-  mEventQueue.pushFront(evt);
+  {
+    std::lock_guard<std::mutex> lck( mFileDropMutex );
+    mFileDrops.push_back(event.getFiles());
+  }
+  pushEvent(CJS_FILE_DROP);
+}
+
+/**
+ * Copies an event into the ring and wakes the event thread (main thread only)
+ */
+void CinderjsApp::pushEvent( int type, float x, float y, int code, uint32_t charCode, uint32_t modifiers )
+{
+  RawEvent evt = { type, x, y, code, charCode, modifiers, getElapsedSeconds() };
+  mEventQueue.push(evt);
   _eventRun = true;
   cvEventThread.notify_one();
 }
 
+template<class E>
+static inline uint32_t _modifiers( const E& event ){
+  return (event.isShiftDown() ? CJS_MOD_SHIFT : 0)
+    | (event.isAltDown() ? CJS_MOD_ALT : 0)
+    | (event.isControlDown() ? CJS_MOD_CTRL : 0)
+    | (event.isMetaDown() ? CJS_MOD_META : 0);
+}
+
 
 
 /**
@@ -618,11 +847,7 @@ void CinderjsApp::fileDrop( FileDropEvent event )
  */
 void CinderjsApp::resize()
 {
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_RESIZE;
-  mEventQueue.pushFront(evt);
-  _eventRun = true;
-  cvEventThread.notify_one();
+  pushEvent(CJS_RESIZE);
 }
 
 /**
@@ -633,6 +858,10 @@ void CinderjsApp::mouseMove( MouseEvent event )
   // Update mouse position (pushed to v8 with draw callback)
   mousePosBuf.x = event.getX();
   mousePosBuf.y = event.getY();
+  
+  mEventQueue.pushMove(CJS_MOUSE_MOVE, event.getX(), event.getY(), _modifiers(event), getElapsedSeconds());
+  _eventRun = true;
+  cvEventThread.notify_one();
 }
 
 /**
@@ -640,12 +869,7 @@ void CinderjsApp::mouseMove( MouseEvent event )
  */
 void CinderjsApp::mouseDown( MouseEvent event )
 {
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_MOUSE_DOWN;
-  evt->mEvt = event;
-  mEventQueue.pushFront(evt);
-  _eventRun = true;
-  cvEventThread.notify_one();
+  pushEvent(CJS_MOUSE_DOWN, event.getX(), event.getY(), event.isRight() ? 2 : event.isMiddle() ? 1 : 0, 0, _modifiers(event));
 }
 
 /**
@@ -653,12 +877,7 @@ void CinderjsApp::mouseDown( MouseEvent event )
  */
 void CinderjsApp::mouseUp( MouseEvent event )
 {
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_MOUSE_UP;
-  evt->mEvt = event;
-  mEventQueue.pushFront(evt);
-  _eventRun = true;
-  cvEventThread.notify_one();
+  pushEvent(CJS_MOUSE_UP, event.getX(), event.getY(), event.isRight() ? 2 : event.isMiddle() ? 1 : 0, 0, _modifiers(event));
 }
 
 /**
@@ -694,12 +913,7 @@ void CinderjsApp::keyDown( KeyEvent event )
   }
   
   
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_KEY_DOWN;
-  evt->kEvt = event;
-  mEventQueue.pushFront(evt);
-  _eventRun = true;
-  cvEventThread.notify_one();
+  pushEvent(CJS_KEY_DOWN, 0, 0, event.getCode(), event.getChar(), _modifiers(event));
 }
 
 /**
@@ -707,12 +921,7 @@ void CinderjsApp::keyDown( KeyEvent event )
  */
 void CinderjsApp::keyUp( KeyEvent event )
 {
-  BufferedEvent evt(new BufferedEventHolder());
-  evt->type = CJS_KEY_UP;
-  evt->kEvt = event;
-  mEventQueue.pushFront(evt);
-  _eventRun = true;
-  cvEventThread.notify_one();
+  pushEvent(CJS_KEY_UP, 0, 0, event.getCode(), event.getChar(), _modifiers(event));
 }
 
 /**
@@ -732,13 +941,31 @@ void CinderjsApp::draw()
   // Quit if requested
   // Push to event queue and execute there (not check every frame, duh)
   if(sQuitRequested) {
-    BufferedEvent evt(new BufferedEventHolder());
-    evt->type = CJS_SHUTDOWN_REQUEST;
-    mEventQueue.pushFront(evt);
+    if(!mShutdownQueued){
+      mShutdownQueued = true;
+      pushEvent(CJS_SHUTDOWN_REQUEST);
+    }
     return;
   }
-
-  v8Draw();
+  
+  // Drawing outside the command buffer can not be replayed, fall back to running js here
+  if(mV8ScriptThread && GLModule::getUnrecordedUse()){
+    AppConsole::log(std::string(GLModule::getUnrecordedUse()) + " draws outside gl.CommandBuffer, leaving pipelined mode", LOG_ERROR);
+    sPipelineLatency = 0;
+  }
+  
+  // Latency changed from js
+  if(sPipelineLatency != mRunningLatency){
+    stopPipeline();
+    if(sPipelineLatency > 0) startPipeline();
+  }
+  
+  if(mV8ScriptThread){
+    v8Replay();
+    v8Overlay();
+  } else {
+    v8Draw();
+  }
 }
 	
 
@@ -778,6 +1005,7 @@ void CinderjsApp::setEventCallback(const v8::FunctionCallbackInfo<v8::Value>& ar
   AppConsole::log("event callback set.");
   
   sEventCallback.Reset(isolate, args[0].As<v8::Function>());
+  sEventBatched = args[1]->BooleanValue();
   
   return;
 }
@@ -804,6 +1032,35 @@ void CinderjsApp::toggleV8Stats(const v8::FunctionCallbackInfo<v8::Value>& args)
   return;
 }
 
+/**
+ * app.setPipelined( latency )
+ * 0 runs js and gl on the main thread (default). With 1 or 2, js runs ahead on a script thread,
+ * only drawing done through gl.CommandBuffer is replayed on the render thread.
+ * Throws once any drawing or matrix call went around the command buffer (gl.clear, Batch.draw, ...),
+ * a pipelined app that makes such a call falls back to latency 0.
+ */
+void CinderjsApp::setPipelined(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  int latency = args[0]->Int32Value();
+  
+  if(latency < 0 || latency > 2){
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Pipeline latency must be 0, 1 or 2 frames")));
+    return;
+  }
+  
+  if(latency > 0 && GLModule::getUnrecordedUse()){
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    std::string msg = std::string(GLModule::getUnrecordedUse()) + " draws outside gl.CommandBuffer, pipelined mode only replays command buffers";
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, msg.c_str())));
+    return;
+  }
+  
+  sPipelineLatency = latency;
+  return;
+}
+
 /**
  * Toggle fps on/off
  */
@@ -841,12 +1098,10 @@ void CinderjsApp::nextFrameJS(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Isolate* isolate = args.GetIsolate();
   HandleScope scope(isolate);
   
-  // TODO: check next frame execution queue and warn (fail) if full
-  
   if(args[0]->IsFunction()){
     NextFrameFn nffn(new NextFrameFnHolder());
     nffn->v8Fn.Reset(isolate, args[0].As<Function>());
-    sExecutionQueue.pushFront(nffn);
+    PipeModule::nextFrame(nffn);
   }
 }
 
@@ -927,19 +1182,9 @@ void CinderjsApp::NativeBinding(const FunctionCallbackInfo<Value>& args) {
   uint32_t len = moduleList->Length();
   moduleList->Set(len, String::NewFromUtf8(isolate, buf.c_str()));
   
-  // Lookup native modules
-  _native mod;
-  bool found = false;
-  for(int i = 0; i < sizeof(natives); i++) {
-    if(natives[i].name == NULL) break;
-    std::string cmp(natives[i].name);
-    if(cmp == "cinder") continue;
-    if(cmp == cmpModName){
-      mod = natives[i];
-      found = true;
-      break;
-    }
-  }
+  // Lookup native modules (cinder.js is the entry point, not a module)
+  int nativeIndex = findNative(*strModuleName);
+  bool found = nativeIndex >= 0 && nativeIndex != sCinderNativeIndex;
   
   // If we only have to check existence, we return here
   if( checkExistence ) {
@@ -954,25 +1199,31 @@ void CinderjsApp::NativeBinding(const FunctionCallbackInfo<Value>& args) {
     
     v8::TryCatch tryCatch;
     
-    // Use wrappers and wrap method set in cinder.js
-    Local<Function> wrap = isolate
-      ->GetCurrentContext()
-      ->Global()
-      ->Get(v8::String::NewFromUtf8(isolate, "process"))
-      .As<Object>()
-      ->Get(v8::String::NewFromUtf8(isolate, "wrap"))
-      .As<Function>()
-    ; // wtf v8...
-    
-    // Check v8 in sanity
-    if(!wrap->IsFunction()) {
-      std::string except = "Native module loading failed: No wrap method on the process object.";
-      isolate->ThrowException(String::NewFromUtf8(isolate, except.c_str()));
-      return;
+    // Use wrappers and wrap method set in cinder.js, looked up once
+    if(sNativeWrap.IsEmpty()){
+      Local<Value> wrapValue = isolate
+        ->GetCurrentContext()
+        ->Global()
+        ->Get(v8::String::NewFromUtf8(isolate, "process"))
+        .As<Object>()
+        ->Get(v8::String::NewFromUtf8(isolate, "wrap"))
+      ; // wtf v8...
+      
+      // Check v8 in sanity
+      if(!wrapValue->IsFunction()) {
+        std::string except = "Native module loading failed: No wrap method on the process object.";
+        isolate->ThrowException(String::NewFromUtf8(isolate, except.c_str()));
+        return;
+      }
+      
+      sNativeWrap.Reset(isolate, wrapValue.As<Function>());
+      sNativeRequire.Reset(isolate, v8::FunctionTemplate::New(isolate, NativeBinding)->GetFunction());
     }
+    Local<Function> wrap = Local<Function>::New(isolate, sNativeWrap);
+    const _native& mod = natives[nativeIndex];
     
     // Try: v8::Local<Context>::New(isolate, pContext)
-    std::shared_ptr<PipeModule> nativeMod = CinderjsApp::NAMED_MODULES[cmpModName];
+    std::shared_ptr<PipeModule> nativeMod = CinderjsApp::NATIVE_MODULES[nativeIndex];
     Local<Object> modObj = isolate->GetCurrentContext()->Global();
     if(nativeMod) {
       Local<ObjectTemplate> ctxGlb = ObjectTemplate::New(isolate);
@@ -986,7 +1237,7 @@ void CinderjsApp::NativeBinding(const FunctionCallbackInfo<Value>& args) {
     std::string filename = cmpModName;
     filename.append(".js");
     Local<Value> modResult = executeScriptString(*wrappedSource, isolate, isolate->GetCurrentContext(),
-      v8::String::NewFromUtf8(isolate, filename.c_str()) );
+      v8::String::NewFromUtf8(isolate, filename.c_str()), cmpModName );
     
     // Check native module validity
     if(modResult.IsEmpty() || !modResult->IsFunction()){
@@ -1004,7 +1255,7 @@ void CinderjsApp::NativeBinding(const FunctionCallbackInfo<Value>& args) {
     Local<Value> argv[3] = {
       exports,
       // use this method as require as native modules won't require external ones(?)
-      v8::Local<v8::Value>::Cast(v8::FunctionTemplate::New(isolate, NativeBinding)->GetFunction()),
+      v8::Local<v8::Value>::Cast(Local<Function>::New(isolate, sNativeRequire)),
       moduleObj
     };
     
@@ -29,6 +29,8 @@
 #include "cinder/ConcurrentCircularBuffer.h"
 
 #include <map>
+#include <deque>
+#include <atomic>
 #include <functional>
 #include <boost/any.hpp>
 
@@ -36,7 +38,9 @@
 #include "AppConsole.h"
 #include "CinderAppBase.hpp"
 #include "StaticFactory.hpp"
+#include "CodeCache.hpp"
 #include "Timer.h"
+#include "EventQueue.h"
 
 #include "v8.h"
 #include "libplatform/libplatform.h"
@@ -48,31 +52,20 @@ namespace cjs {
 
 typedef boost::filesystem::path Path;
 
-class BufferedEventHolder {
-  public:
-  int type;
-  cinder::app::MouseEvent mEvt;
-  cinder::app::KeyEvent kEvt;
-  std::vector<cinder::fs::path> fdFiles;
-  v8::Persistent<v8::Function> v8Fn;
-};
-typedef std::shared_ptr<BufferedEventHolder> BufferedEvent;
 
-class NextFrameFnHolder {
-  public:
-  v8::Persistent<v8::Function> v8Fn;
-  bool repeat = false;
-};
-typedef std::shared_ptr<NextFrameFnHolder> NextFrameFn;
+// Recorded GL commands for one script frame (pipelined mode, see GLCommand)
+typedef std::shared_ptr<std::vector<float>> FrameCommands;
 
 enum EventType {
   CJS_SHUTDOWN_REQUEST = 0,
   //CJS_NEXT_FRAME = 1,
+  CJS_EVENT_BATCH = 2,
   CJS_RESIZE = 10,
   CJS_KEY_DOWN = 20,
   CJS_KEY_UP = 30,
   CJS_MOUSE_DOWN = 40,
   CJS_MOUSE_UP = 50,
+  CJS_MOUSE_MOVE = 60,
   CJS_FILE_DROP = 100
 };
 
@@ -90,7 +83,7 @@ enum EventType {
 
 class CinderjsApp : public CinderAppBase  {
   public:
-  CinderjsApp() : mEventQueue(1024) {}
+  CinderjsApp() : mFramePool(4) {}
   ~CinderjsApp(){}
   
   // Cinder App
@@ -109,14 +102,15 @@ class CinderjsApp : public CinderAppBase  {
   // V8 Setup
   void v8Setup( std::string jsFileContents );
   static v8::Local<v8::Value> executeScriptString( std::string scriptStr, v8::Isolate* isolate,
-    v8::Local<v8::Context> context, v8::Handle<v8::String> filename );
+    v8::Local<v8::Context> context, v8::Handle<v8::String> filename, std::string cacheKey = "" );
   
   //
   private:
   
   // Stats
+  // Written by the script thread, read by the render thread's overlay in pipelined mode
   volatile int v8Frames = 0;
-  volatile double v8FPS = 0;
+  std::atomic<double> v8FPS { 0 };
   volatile int mLastUpdate = 0;
   volatile int mUpdateInterval = 1000;
   
@@ -132,8 +126,14 @@ class CinderjsApp : public CinderAppBase  {
   cinder::app::RendererRef glRenderer;
   
   // Eventing
-  cinder::ConcurrentCircularBuffer<BufferedEvent> mEventQueue;
+  // Input events go through a lock free ring, file drops (rare, not POD) through a locked side list
+  EventQueue<1024> mEventQueue;
+  std::mutex mFileDropMutex;
+  std::deque<std::vector<cinder::fs::path>> mFileDrops;
+  bool mShutdownQueued = false;
+  void pushEvent( int type, float x = 0, float y = 0, int code = 0, uint32_t charCode = 0, uint32_t modifiers = 0 );
   static cinder::ConcurrentCircularBuffer<NextFrameFn> sExecutionQueue;
+  std::vector<NextFrameFn> mOverflow; // Execution queue overflow taken for the current frame
   volatile cinder::vec2 mousePosBuf;
   
   // Path
@@ -143,8 +143,25 @@ class CinderjsApp : public CinderAppBase  {
   void v8EventThread( cinder::gl::ContextRef context );
   std::shared_ptr<std::thread> mV8EventThread;
   
+  // Pipelining
+  // With a latency of 1 or 2 frames, js runs on the script thread and records gl commands
+  // while the render thread replays the last completed frame.
+  // The frame queue holds `latency` frames, the script thread blocks when it is full.
+  void v8ScriptThread( cinder::gl::ContextRef context );
+  void startPipeline();
+  void stopPipeline();
+  std::shared_ptr<std::thread> mV8ScriptThread;
+  std::unique_ptr<cinder::ConcurrentCircularBuffer<FrameCommands>> mFrameQueue;
+  cinder::ConcurrentCircularBuffer<FrameCommands> mFramePool;
+  FrameCommands mLastFrame;
+  int mRunningLatency = 0;
+  static std::atomic<int> sPipelineLatency;
+  
   // Modules
   static v8::Persistent<v8::Object> sModuleCache;
+  static v8::Persistent<v8::Function> sNativeWrap;     // process.wrap from cinder.js
+  static v8::Persistent<v8::Function> sNativeRequire;  // NativeBinding, passed as require to natives
+  static const int sCinderNativeIndex;
   static v8::Persistent<v8::Array> sModuleList;
   
   // GC
@@ -160,6 +177,7 @@ class CinderjsApp : public CinderAppBase  {
   static void requestQuit(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void nextFrameJS(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void setTimer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void setPipelined(const v8::FunctionCallbackInfo<v8::Value>& args);
   
   // Default Process Bindings
   static void NativeBinding(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -169,6 +187,15 @@ class CinderjsApp : public CinderAppBase  {
   static v8::Local<v8::Function> _fnDrawCallback;
   static v8::Persistent<v8::Function> sEventCallback; // TODO: only push events that were subscribed to in v8
   
+  // Batched event delivery (__event__(fn, true))
+  // All events of one wake-up go to js in a single call: (CJS_EVENT_BATCH, count, ints, floats)
+  // ints: [type, code, charCode, modifiers] floats: [x, y, timestamp] per event,
+  // resize events carry the window size in x/y. Both arrays are reused.
+  static const int kEventBatchSize = 1024;
+  static bool sEventBatched;
+  static v8::Persistent<v8::Int32Array> sEventInts;
+  static v8::Persistent<v8::Float64Array> sEventFloats;
+  
   //
   static v8::Persistent<v8::Object> sEmptyObject;
   
@@ -181,6 +208,9 @@ class CinderjsApp : public CinderAppBase  {
   static void handleV8TryCatch( v8::TryCatch &tryCatch, std::string info );
   
   // Timers
+  // Not threaded, due timers are dispatched on the script thread once per frame.
+  // kTimerBudgetMs limits the time spent on them per frame, the rest spill over to the next frame.
+  static const int kTimerBudgetMs = 4;
   static Timer _mainTimer;
   static std::function<void(boost::any passOn)> _timerCallback;
   
@@ -191,8 +221,18 @@ class CinderjsApp : public CinderAppBase  {
   double mLastEscPressed;
   
   void v8Draw();
-  double lastFrameTime = 0;
-  v8::HeapStatistics _mHeapStats;
+  void v8Script( std::vector<float>* record );
+  void v8Replay();
+  void v8Overlay();
+  std::atomic<double> lastFrameTime { 0 };
+  
+  // Heap statistics snapshot, sampled by the script thread
+  std::atomic<size_t> mHeapLimit { 0 };
+  std::atomic<size_t> mHeapTotal { 0 };
+  std::atomic<size_t> mHeapUsed { 0 };
+  
+  // FPS / stats overlay, only the vertices of changed digits are uploaded per frame
+  TextMesh mOverlayText;
 };
   
 } // namespace cjs
@@ -0,0 +1,332 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "atlas.hpp"
+#include "AppConsole.h"
+#include "gl.hpp"
+#include "../StaticFactory.hpp"
+#include "cinder/gl/scoped.h"
+#include "cinder/ImageIo.h"
+
+using namespace std;
+using namespace cinder;
+using namespace cinder::gl;
+using namespace v8;
+
+namespace cjs {
+
+GlslProgRef AtlasModule::sSpriteShader;
+
+GlslProgRef AtlasModule::getSpriteShader() {
+  if(!sSpriteShader){
+    sSpriteShader = GlslProg::create(GlslProg::Format()
+      .vertex(CI_GLSL(150,
+        uniform mat4 ciModelViewProjection;
+        in vec4 ciPosition;
+        in vec4 iRect;
+        in vec4 iUv;
+        in vec4 iColor;
+        in float iLayer;
+        out vec3 vTexCoord;
+        out vec4 vColor;
+        void main() {
+          vTexCoord = vec3(mix(iUv.xy, iUv.zw, ciPosition.xy), iLayer);
+          vColor = iColor;
+          gl_Position = ciModelViewProjection * vec4(iRect.xy + ciPosition.xy * iRect.zw, 0.0, 1.0);
+        }
+      ))
+      .fragment(CI_GLSL(150,
+        uniform sampler2DArray uAtlas;
+        in vec3 vTexCoord;
+        in vec4 vColor;
+        out vec4 oColor;
+        void main() {
+          oColor = texture(uAtlas, vTexCoord) * vColor;
+        }
+      ))
+    );
+    sSpriteShader->uniform("uAtlas", 0);
+  }
+  return sSpriteShader;
+}
+
+/**
+ * create( handle, pageSize )
+ */
+void AtlasModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  int32_t pageSize = args[1]->IsUndefined() ? 2048 : args[1]->Int32Value();
+  
+  GLint maxSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+  if(pageSize < 16 || pageSize > maxSize){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Atlas page size out of range")));
+    return;
+  }
+  
+  AtlasRef atlas(new Atlas(pageSize));
+  StaticFactory::put<Atlas>( isolate, atlas, args[0]->ToObject() );
+}
+
+void AtlasModule::destroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  StaticFactory::remove<Atlas>(isolate, args[0]);
+}
+
+/**
+ * add( handle, imagePath )
+ * Loads the image and packs it into the first page with room, a new page is started if none has.
+ * @return {page, x, y, width, height, u0, v0, u1, v1}
+ */
+void AtlasModule::add(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  AtlasRef atlas = StaticFactory::get<Atlas>(args[0]);
+  
+  if(!atlas){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Atlas does not exist")));
+    return;
+  }
+  
+  v8::String::Utf8Value path(args[1]->ToString());
+  
+  Surface8u image;
+  try {
+    image = Surface8u(loadImage( getApp()->loadAsset(fs::path(*path)) ), SurfaceConstraintsDefault(), true);
+  } catch(std::exception &ex){
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, ex.what())));
+    return;
+  }
+  
+  int w = image.getWidth();
+  int h = image.getHeight();
+  int padded = atlas->padding * 2;
+  if(w + padded > atlas->pageSize || h + padded > atlas->pageSize){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Image does not fit into an atlas page")));
+    return;
+  }
+  
+  int page = -1;
+  int x, y;
+  for(size_t i = 0; i < atlas->packers.size(); i++){
+    if(atlas->packers[i].insert(w + padded, h + padded, &x, &y)){
+      page = (int)i;
+      break;
+    }
+  }
+  if(page < 0){
+    atlas->packers.push_back(SkylinePacker(atlas->pageSize, atlas->pageSize));
+    atlas->pages.push_back(Surface8u(atlas->pageSize, atlas->pageSize, true, SurfaceChannelOrder::RGBA));
+    memset(atlas->pages.back().getData(), 0, atlas->pages.back().getRowBytes() * atlas->pageSize);
+    page = (int)atlas->packers.size() - 1;
+    atlas->packers.back().insert(w + padded, h + padded, &x, &y);
+  }
+  
+  x += atlas->padding;
+  y += atlas->padding;
+  Surface8u& target = atlas->pages[page];
+  target.copyFrom(image, image.getBounds(), ivec2(x, y));
+  
+  // Extrude the border pixels into the padding, so linear filtering at the edges of a scaled
+  // or rotated sprite blends with its own border instead of transparent padding
+  int p = atlas->padding;
+  for(int i = 1; i <= p; i++){
+    target.copyFrom(image, Area(0, 0, 1, h), ivec2(x - i, y));
+    target.copyFrom(image, Area(w - 1, 0, w, h), ivec2(x + i, y));
+  }
+  for(int i = 1; i <= p; i++){
+    target.copyFrom(target, Area(x - p, y, x + w + p, y + 1), ivec2(0, -i));
+    target.copyFrom(target, Area(x - p, y + h - 1, x + w + p, y + h), ivec2(0, i));
+  }
+  
+  float size = (float)atlas->pageSize;
+  Local<Object> entry = Object::New(isolate);
+  entry->Set(v8::String::NewFromUtf8(isolate, "page"), v8::Int32::New(isolate, page));
+  entry->Set(v8::String::NewFromUtf8(isolate, "x"), v8::Int32::New(isolate, x));
+  entry->Set(v8::String::NewFromUtf8(isolate, "y"), v8::Int32::New(isolate, y));
+  entry->Set(v8::String::NewFromUtf8(isolate, "width"), v8::Int32::New(isolate, w));
+  entry->Set(v8::String::NewFromUtf8(isolate, "height"), v8::Int32::New(isolate, h));
+  entry->Set(v8::String::NewFromUtf8(isolate, "u0"), v8::Number::New(isolate, x / size));
+  entry->Set(v8::String::NewFromUtf8(isolate, "v0"), v8::Number::New(isolate, y / size));
+  entry->Set(v8::String::NewFromUtf8(isolate, "u1"), v8::Number::New(isolate, (x + w) / size));
+  entry->Set(v8::String::NewFromUtf8(isolate, "v1"), v8::Number::New(isolate, (y + h) / size));
+  
+  args.GetReturnValue().Set(entry);
+}
+
+/**
+ * build( handle )
+ * Uploads all pages into one GL_TEXTURE_2D_ARRAY.
+ */
+void AtlasModule::build(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  AtlasRef atlas = StaticFactory::get<Atlas>(args[0]);
+  
+  if(!atlas){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Atlas does not exist")));
+    return;
+  }
+  
+  if(atlas->pages.empty()){
+    return;
+  }
+  
+  int layers = (int)atlas->pages.size();
+  if(!atlas->texture || atlas->texture->getDepth() != layers){
+    atlas->texture = Texture3d::create(atlas->pageSize, atlas->pageSize, layers, Texture3d::Format()
+      .target(GL_TEXTURE_2D_ARRAY)
+      .internalFormat(GL_RGBA8)
+      .minFilter(GL_LINEAR)
+      .magFilter(GL_LINEAR)
+      .wrap(GL_CLAMP_TO_EDGE)
+    );
+  }
+  
+  for(int i = 0; i < layers; i++){
+    atlas->texture->update(atlas->pages[i], i);
+  }
+}
+
+/**
+ * createSpriteBatch( handle, capacity )
+ */
+void AtlasModule::createSpriteBatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  int32_t capacity = args[1]->Int32Value();
+  if(capacity < 1){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "SpriteBatch capacity must be at least 1")));
+    return;
+  }
+  
+  SpriteBatchRef sprites(new SpriteBatch());
+  sprites->capacity = capacity;
+  
+  size_t stride = SpriteBatch::kFloatsPerSprite * sizeof(float);
+  sprites->instances = Vbo::create(GL_ARRAY_BUFFER, capacity * stride, nullptr, GL_STREAM_DRAW);
+  
+  geom::BufferLayout layout;
+  layout.append(geom::CUSTOM_0, 4, stride, 0, 1);
+  layout.append(geom::CUSTOM_1, 4, stride, 4 * sizeof(float), 1);
+  layout.append(geom::CUSTOM_2, 4, stride, 8 * sizeof(float), 1);
+  layout.append(geom::CUSTOM_3, 1, stride, 12 * sizeof(float), 1);
+  
+  VboMeshRef mesh = VboMesh::create(geom::Rect(Rectf(0, 0, 1, 1)));
+  mesh->appendVbo(layout, sprites->instances);
+  
+  Batch::AttributeMapping mapping;
+  mapping[geom::CUSTOM_0] = "iRect";
+  mapping[geom::CUSTOM_1] = "iUv";
+  mapping[geom::CUSTOM_2] = "iColor";
+  mapping[geom::CUSTOM_3] = "iLayer";
+  
+  sprites->batch = Batch::create(mesh, getSpriteShader(), mapping);
+  
+  StaticFactory::put<SpriteBatch>( isolate, sprites, args[0]->ToObject() );
+}
+
+void AtlasModule::destroySpriteBatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  StaticFactory::remove<SpriteBatch>(isolate, args[0]);
+}
+
+/**
+ * drawSprites( handle, atlasHandle, data, count )
+ * data is a Float32Array with SpriteBatch::kFloatsPerSprite floats per sprite,
+ * all sprites are drawn with one instanced draw call and one texture bind.
+ */
+void AtlasModule::drawSprites(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  SpriteBatchRef sprites = StaticFactory::get<SpriteBatch>(args[0]);
+  AtlasRef atlas = StaticFactory::get<Atlas>(args[1]);
+  
+  if(!sprites || !atlas){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "SpriteBatch or Atlas does not exist")));
+    return;
+  }
+  
+  if(!atlas->texture){
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, "Atlas is not built")));
+    return;
+  }
+  
+  if(!args[2]->IsFloat32Array()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "Sprite data must be a Float32Array")));
+    return;
+  }
+  
+  Local<Float32Array> data = args[2].As<Float32Array>();
+  uint32_t count = args[3]->Uint32Value();
+  if(count == 0){
+    return;
+  }
+  
+  GLModule::checkUnrecorded("SpriteBatch.draw");
+  if(count > sprites->capacity || count * SpriteBatch::kFloatsPerSprite > data->Length()){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Sprite count exceeds the batch")));
+    return;
+  }
+  
+  const char* bytes = static_cast<char*>(data->Buffer()->GetContents().Data()) + data->ByteOffset();
+  size_t byteLength = count * SpriteBatch::kFloatsPerSprite * sizeof(float);
+  
+  // Orphan, so the driver does not wait for the previous frame's draw
+  sprites->instances->bufferData(sprites->instances->getSize(), nullptr, GL_STREAM_DRAW);
+  sprites->instances->bufferSubData(0, byteLength, bytes);
+  
+  gl::ScopedTextureBind bind(atlas->texture, 0);
+  sprites->batch->drawInstanced(count);
+}
+
+/**
+ * Add JS bindings
+ */
+void AtlasModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
+  // Create global atlas object
+  Handle<ObjectTemplate> atlasTemplate = ObjectTemplate::New(getIsolate());
+  
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "create"), v8::FunctionTemplate::New(getIsolate(), create));
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroy"), v8::FunctionTemplate::New(getIsolate(), destroy));
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "add"), v8::FunctionTemplate::New(getIsolate(), add));
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "build"), v8::FunctionTemplate::New(getIsolate(), build));
+  
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createSpriteBatch"), v8::FunctionTemplate::New(getIsolate(), createSpriteBatch));
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroySpriteBatch"), v8::FunctionTemplate::New(getIsolate(), destroySpriteBatch));
+  atlasTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "drawSprites"), v8::FunctionTemplate::New(getIsolate(), drawSprites));
+  
+  // Expose global atlas object
+  global->Set(v8::String::NewFromUtf8(getIsolate(), "atlas"), atlasTemplate);
+}
+ 
+} // namespace cjs
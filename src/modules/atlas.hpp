@@ -0,0 +1,97 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _AtlasModule_hpp_
+#define _AtlasModule_hpp_
+
+#pragma once
+
+#define ATLAS_MOD_ID 17
+
+#include "../PipeModule.hpp"
+#include "../utils/SkylinePacker.h"
+#include "cinder/Surface.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Batch.h"
+#include "cinder/gl/Vbo.h"
+
+namespace cjs {
+
+//
+// Images packed into pages of a GL_TEXTURE_2D_ARRAY, one layer per page.
+// Pages are kept on the CPU until build() uploads them, images can be added after a build,
+// the next build uploads again.
+class Atlas {
+  public:
+  Atlas( int pageSize ) : pageSize(pageSize) {}
+  
+  int pageSize;
+  int padding = 1; // Around each image, filled with its extruded border pixels
+  std::vector<SkylinePacker> packers;
+  std::vector<cinder::Surface8u> pages;
+  cinder::gl::Texture3dRef texture;
+};
+typedef std::shared_ptr<Atlas> AtlasRef;
+
+//
+// Instanced quads from one atlas, per sprite: rect (x, y, w, h), uv (u0, v0, u1, v1), color (rgba), layer
+class SpriteBatch {
+  public:
+  static const int kFloatsPerSprite = 13;
+  
+  size_t capacity = 0;
+  cinder::gl::VboRef instances;
+  cinder::gl::BatchRef batch;
+};
+typedef std::shared_ptr<SpriteBatch> SpriteBatchRef;
+
+class AtlasModule : public PipeModule {
+  public:
+    AtlasModule(){}
+    ~AtlasModule(){}
+  
+    inline int moduleId() {
+      return ATLAS_MOD_ID;
+    }
+  
+    inline std::string getName() {
+      return "atlas";
+    }
+  
+    static void create(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void add(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void build(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
+    static void createSpriteBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void destroySpriteBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void drawSprites(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
+    void loadGlobalJS( v8::Local<v8::ObjectTemplate> &global );
+  
+  private:
+    static cinder::gl::GlslProgRef getSpriteShader();
+    static cinder::gl::GlslProgRef sSpriteShader;
+ };
+  
+} // namespace cjs
+
+#endif
@@ -22,9 +22,11 @@
 
 #include "batch.hpp"
 #include "AppConsole.h"
+#include "gl.hpp"
 #include "../StaticFactory.hpp"
 #include "cinder/gl/Batch.h"
 #include "cinder/gl/Shader.h"
+#include "cinder/gl/VboMesh.h"
 
 using namespace std;
 using namespace cinder;
@@ -35,6 +37,12 @@ namespace cjs {
 
 vec3 BatchModule::sBufVec3f_1;
 
+/**
+ * create( handle, geomMesh, shaderId, instanceAttribs )
+ * instanceAttribs is an optional array of { vbo, name, dims, stride, offset, divisor },
+ * each Vbo is appended to the mesh as a per-instance attribute (CUSTOM_0 - CUSTOM_9)
+ * and mapped to the named shader input.
+ */
 void BatchModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
@@ -55,7 +63,45 @@ void BatchModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
       return;
     }
     
-    batch = Batch::create(geom::Cube(), shader);
+    if(args.Length() > 3 && args[3]->IsArray()){
+      Local<Array> attribs = args[3].As<Array>();
+      
+      if(attribs->Length() > geom::CUSTOM_9 - geom::CUSTOM_0 + 1){
+        isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Too many instance attributes (max 10)")));
+        return;
+      }
+      
+      VboMeshRef mesh = VboMesh::create(geom::Cube());
+      Batch::AttributeMapping mapping;
+      
+      for(uint32_t i = 0; i < attribs->Length(); i++){
+        Local<Object> attrib = attribs->Get(i)->ToObject();
+        
+        VboRef vbo = StaticFactory::get<Vbo>(attrib->Get(v8::String::NewFromUtf8(isolate, "vbo")));
+        if(!vbo){
+          isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Instance Vbo does not exist")));
+          return;
+        }
+        
+        v8::String::Utf8Value name(attrib->Get(v8::String::NewFromUtf8(isolate, "name")));
+        geom::Attrib semantic = (geom::Attrib)(geom::CUSTOM_0 + i);
+        
+        geom::BufferLayout layout;
+        layout.append(semantic,
+          attrib->Get(v8::String::NewFromUtf8(isolate, "dims"))->Uint32Value(),
+          attrib->Get(v8::String::NewFromUtf8(isolate, "stride"))->Uint32Value(),
+          attrib->Get(v8::String::NewFromUtf8(isolate, "offset"))->Uint32Value(),
+          attrib->Get(v8::String::NewFromUtf8(isolate, "divisor"))->Uint32Value()
+        );
+        
+        mesh->appendVbo(layout, vbo);
+        mapping[semantic] = *name;
+      }
+      
+      batch = Batch::create(mesh, shader, mapping);
+    } else {
+      batch = Batch::create(geom::Cube(), shader);
+    }
     
     
   } else {
@@ -95,12 +141,33 @@ void BatchModule::draw(const v8::FunctionCallbackInfo<v8::Value>& args) {
       return;
     }
     
+    GLModule::checkUnrecorded("Batch.draw");
     batch->draw();
   }
   
   return;
 }
 
+/**
+ * drawInstanced( handle, count )
+ */
+void BatchModule::drawInstanced(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  BatchRef batch = StaticFactory::get<Batch>(args[0]);
+  
+  if(!batch){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Batch does not exist")));
+    return;
+  }
+  
+  GLModule::checkUnrecorded("Batch.drawInstanced");
+  batch->drawInstanced(args[1]->Int32Value());
+  
+  return;
+}
+
 //
 // VertBatch
 
@@ -141,6 +208,7 @@ void BatchModule::drawVert(const v8::FunctionCallbackInfo<v8::Value>& args) {
       return;
     }
     
+    GLModule::checkUnrecorded("VertBatch.draw");
     batch->draw();
   }
   
@@ -233,6 +301,7 @@ void BatchModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "create"), v8::FunctionTemplate::New(getIsolate(), create));
   batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroy"), v8::FunctionTemplate::New(getIsolate(), destroy));
   batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "draw"), v8::FunctionTemplate::New(getIsolate(), draw));
+  batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "drawInstanced"), v8::FunctionTemplate::New(getIsolate(), drawInstanced));
   
   batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createVert"), v8::FunctionTemplate::New(getIsolate(), createVert));
   batchTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroyVert"), v8::FunctionTemplate::New(getIsolate(), destroyVert));
@@ -46,6 +46,7 @@ class BatchModule : public PipeModule {
     static void create(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void draw(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void drawInstanced(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     static void createVert(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void destroyVert(const v8::FunctionCallbackInfo<v8::Value>& args);
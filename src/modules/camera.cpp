@@ -64,9 +64,7 @@ void CameraModule::destroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    StaticFactory::remove<CameraPersp>(isolate, id);
+    StaticFactory::remove<CameraPersp>(isolate, args[0]);
   }
   
   return;
@@ -78,9 +76,7 @@ void CameraModule::setEyePoint(const v8::FunctionCallbackInfo<v8::Value>& args)
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -102,9 +98,7 @@ void CameraModule::lookAt(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -130,9 +124,7 @@ void CameraModule::setViewDirection(const v8::FunctionCallbackInfo<v8::Value>& a
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -154,9 +146,7 @@ void CameraModule::setOrientation(const v8::FunctionCallbackInfo<v8::Value>& arg
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -178,9 +168,7 @@ void CameraModule::generateRay(const v8::FunctionCallbackInfo<v8::Value>& args)
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -201,9 +189,7 @@ void CameraModule::setCenterOfInterestPoint(const v8::FunctionCallbackInfo<v8::V
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
@@ -226,9 +212,7 @@ void CameraModule::setPerspective(const v8::FunctionCallbackInfo<v8::Value>& arg
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
+    std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(args[0]);
     
     if(!cam){
       _handleNoCameraError(isolate);
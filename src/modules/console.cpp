@@ -22,6 +22,7 @@
 
 #include "console.hpp"
 #include "AppConsole.h"
+#include <algorithm>
 
 using namespace std;
 using namespace cinder;
@@ -33,16 +34,39 @@ void LogCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope handle_scope(isolate);
   
   v8::String::Utf8Value str(args[0]);
-  AppConsole::log( *str );
+  LogLevel level = args[1]->IsUndefined() ? LOG_INFO : (LogLevel)std::min(std::max(args[1]->Int32Value(), 0), 2);
+  AppConsole::log( *str, level );
   
   return;
 }
 
+/**
+ * setLogCapacity( maxLines, maxBytes )
+ */
+void SetLogCapacityCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(args[0]->Int32Value() < 1 || args[1]->Int32Value() < 1){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Log capacity must be at least one line and one byte")));
+    return;
+  }
+  
+  AppConsole::setCapacity( args[0]->Uint32Value(), args[1]->Uint32Value() );
+  args.GetReturnValue().Set(v8::Number::New(isolate, AppConsole::getMemoryUsage()));
+}
+
+void SetLogTimestampsCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  AppConsole::setShowTimestamps( args[0]->BooleanValue() );
+}
+
 /**
  * Add JS bindings
  */
 void ConsoleModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   global->Set(v8::String::NewFromUtf8(getIsolate(), "log"), v8::FunctionTemplate::New(getIsolate(), LogCallback));
+  global->Set(v8::String::NewFromUtf8(getIsolate(), "setLogCapacity"), v8::FunctionTemplate::New(getIsolate(), SetLogCapacityCallback));
+  global->Set(v8::String::NewFromUtf8(getIsolate(), "setLogTimestamps"), v8::FunctionTemplate::New(getIsolate(), SetLogTimestampsCallback));
 }
  
 } // namespace cjs
\ No newline at end of file
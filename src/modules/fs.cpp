@@ -22,11 +22,19 @@
 
 #include "fs.hpp"
 #include "AppConsole.h"
+#include "../StaticFactory.hpp"
+#include "../FileWatcher.hpp"
 
 #include <string.h>
-#include <fstream>
-#include <sstream>
 #include <cerrno>
+#include <ctime>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "cinder/Filesystem.h"
 
@@ -80,40 +88,997 @@ void statSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
   return;
 }
 
+//
+// Read only files are memory mapped, the mapping backs the js value directly.
+
+class MappedFile {
+  public:
+  ~MappedFile(){
+    if(data) munmap(data, size);
+  }
+  
+  // errno is set on failure
+  bool map( const char* path ){
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return false;
+    
+    struct stat st;
+    if(fstat(fd, &st) != 0){
+      int err = errno;
+      close(fd);
+      errno = err;
+      return false;
+    }
+    
+    size = (size_t)st.st_size;
+    if(size > 0){
+      // Private and writable: js may write to the ArrayBuffer, pages are only copied when touched
+      void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if(ptr == MAP_FAILED){
+        int err = errno;
+        close(fd);
+        errno = err;
+        return false;
+      }
+      data = ptr;
+    }
+    close(fd);
+    return true;
+  }
+  
+  bool isAscii() const {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for(size_t i = 0; i < size; i++){
+      if(bytes[i] & 0x80) return false;
+    }
+    return true;
+  }
+  
+  void* data = nullptr;
+  size_t size = 0;
+};
+
+// Binary mode, unmaps when the ArrayBuffer is collected
+class MappedArrayBuffer {
+  public:
+  static Local<ArrayBuffer> create( Isolate* isolate, std::shared_ptr<MappedFile> file ){
+    EscapableHandleScope scope(isolate);
+    
+    // Externalized, v8 does not free the mapped memory
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, file->data, file->size);
+    
+    MappedArrayBuffer* holder = new MappedArrayBuffer();
+    holder->file = std::move(file);
+    holder->handle.Reset(isolate, buffer);
+    holder->handle.SetWeak(holder, WeakCallback);
+    holder->handle.MarkIndependent();
+    isolate->AdjustAmountOfExternalAllocatedMemory(holder->file->size);
+    
+    return scope.Escape(buffer);
+  }
+  
+  private:
+  static void WeakCallback(const v8::WeakCallbackData<v8::ArrayBuffer, MappedArrayBuffer>& data) {
+    MappedArrayBuffer* holder = data.GetParameter();
+    data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-(int64_t)holder->file->size);
+    holder->handle.Reset();
+    delete holder;
+  }
+  
+  std::shared_ptr<MappedFile> file;
+  v8::Persistent<v8::ArrayBuffer> handle;
+};
+
+static Local<Value> fileError( Isolate* isolate, int err, const std::string& path ){
+  std::string msg = err == ENOENT ? "File not found: " : "Error: " + std::string(strerror(err)) + ", ";
+  msg.append(path);
+  return v8::Exception::Error(v8::String::NewFromUtf8(isolate, msg.c_str()));
+}
+
+/**
+ * Binary returns an ArrayBuffer backed by the mapping. Untouched pages still follow the file,
+ * its contents change when the file is written in place and reading past a truncated end
+ * raises SIGBUS, copy what is kept around.
+ * Text returns a string copied out of the mapping (utf8, one byte for ascii files), so the
+ * mapping is released with the file and v8 never holds on to it as script source.
+ */
+static Local<Value> mappedFileValue( Isolate* isolate, std::shared_ptr<MappedFile> file, bool binary ){
+  EscapableHandleScope scope(isolate);
+  
+  if(binary){
+    if(file->size == 0){
+      return scope.Escape(ArrayBuffer::New(isolate, 0));
+    }
+    return scope.Escape(MappedArrayBuffer::create(isolate, file));
+  }
+  
+  if(file->size == 0){
+    return scope.Escape(v8::String::Empty(isolate));
+  }
+  
+  if(file->isAscii()){
+    return scope.Escape(v8::String::NewFromOneByte(isolate, (const uint8_t*)file->data,
+      v8::String::kNormalString, (int)file->size));
+  }
+  
+  return scope.Escape(v8::String::NewFromUtf8(isolate, (const char*)file->data,
+    v8::String::kNormalString, (int)file->size));
+}
+
+/**
+ * readFileSync( path, binary )
+ */
 void readFileSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope handle_scope(isolate);
   
   String::Utf8Value path(args[0]->ToString());
+  bool binary = args[1]->BooleanValue();
+  
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  if(!file->map(*path)){
+    isolate->ThrowException(fileError(isolate, errno, *path));
+    return;
+  }
+  
+  args.GetReturnValue().Set(mappedFileValue(isolate, file, binary));
   
-  // Do we have a js file to run?
-  std::string jsFileContents;
-  if( !cinder::fs::exists( fs::path::path(*path) ) ){
-    std::string err = "File not found: ";
-    err.append(*path);
-    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, err.c_str())));
+  return;
+}
+
+//
+// Async file I/O
+//
+// The file work runs on the shared worker pool, the js callback is queued for the next frame
+// with the results (NextFrameFnHolder::complete) and called as callback(err, result).
+
+static NextFrameFn asyncCallback( Isolate* isolate, Local<Value> callback ){
+  NextFrameFn nffn(new NextFrameFnHolder());
+  nffn->v8Fn.Reset(isolate, callback.As<Function>());
+  return nffn;
+}
+
+static void callWithResult( Isolate* isolate, Local<Function> callback, Local<Value> err, Local<Value> result ){
+  Local<Value> argv[2] = { err, result };
+  callback->Call(callback->CreationContext()->Global(), 2, argv);
+}
+
+/**
+ * readFile( path, binary, callback )
+ */
+void readFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[2]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "readFile needs a callback")));
     return;
+  }
+  
+  String::Utf8Value pathStr(args[0]->ToString());
+  std::string path(*pathStr);
+  bool binary = args[1]->BooleanValue();
+  NextFrameFn nffn = asyncCallback(isolate, args[2]);
+  
+  PipeModule::getWorkerPool().submit([=](){
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    int err = file->map(path.c_str()) ? 0 : errno;
+    
+    nffn->complete = [=](Isolate* isolate, Local<Function> callback){
+      if(err){
+        callWithResult(isolate, callback, fileError(isolate, err, path), v8::Undefined(isolate));
+      } else {
+        callWithResult(isolate, callback, v8::Null(isolate), mappedFileValue(isolate, file, binary));
+      }
+    };
+    PipeModule::nextFrame(nffn);
+  });
+}
+
+/**
+ * writeFile( path, data, callback )
+ * data is a string (written as utf8), an ArrayBuffer or an ArrayBufferView, it is copied before returning.
+ */
+void writeFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[2]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "writeFile needs a callback")));
+    return;
+  }
+  
+  String::Utf8Value pathStr(args[0]->ToString());
+  std::string path(*pathStr);
+  
+  std::shared_ptr<std::string> data(new std::string());
+  if(args[1]->IsArrayBuffer()){
+    ArrayBuffer::Contents contents = args[1].As<ArrayBuffer>()->GetContents();
+    data->assign((const char*)contents.Data(), contents.ByteLength());
+  } else if(args[1]->IsArrayBufferView()){
+    Local<ArrayBufferView> view = args[1].As<ArrayBufferView>();
+    ArrayBuffer::Contents contents = view->Buffer()->GetContents();
+    data->assign((const char*)contents.Data() + view->ByteOffset(), view->ByteLength());
   } else {
-    try {
-      std::ifstream in(*path, std::ios::in );
-      if (in)
+    String::Utf8Value str(args[1]->ToString());
+    data->assign(*str, str.length());
+  }
+  
+  NextFrameFn nffn = asyncCallback(isolate, args[2]);
+  
+  PipeModule::getWorkerPool().submit([=](){
+    int err = 0;
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+      err = errno;
+    } else {
+      size_t written = 0;
+      while(written < data->size()){
+        ssize_t n = write(fd, data->data() + written, data->size() - written);
+        if(n < 0){
+          if(errno == EINTR) continue;
+          err = errno;
+          break;
+        }
+        written += n;
+      }
+      if(close(fd) != 0 && !err){
+        err = errno;
+      }
+    }
+    
+    nffn->complete = [=](Isolate* isolate, Local<Function> callback){
+      Local<Value> argv[1] = { err ? fileError(isolate, err, path) : v8::Null(isolate).As<Value>() };
+      callback->Call(callback->CreationContext()->Global(), 1, argv);
+    };
+    PipeModule::nextFrame(nffn);
+  });
+}
+
+/**
+ * stat( path, callback ) (async)
+ * Calls back with {isDirectory, isSymbolicLink, size, mtime} or an error if the path does not exist.
+ */
+void statAsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[1]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "stat needs a callback")));
+    return;
+  }
+  
+  String::Utf8Value pathStr(args[0]->ToString());
+  std::string path(*pathStr);
+  NextFrameFn nffn = asyncCallback(isolate, args[1]);
+  
+  PipeModule::getWorkerPool().submit([=](){
+    struct stat st;
+    struct stat lst;
+    int err = ::stat(path.c_str(), &st) == 0 ? 0 : errno;
+    bool isSymbolic = lstat(path.c_str(), &lst) == 0 && S_ISLNK(lst.st_mode);
+    
+    nffn->complete = [=](Isolate* isolate, Local<Function> callback){
+      if(err){
+        callWithResult(isolate, callback, fileError(isolate, err, path), v8::Undefined(isolate));
+        return;
+      }
+      Local<Object> statObj = Object::New(isolate);
+      statObj->Set(v8::String::NewFromUtf8(isolate, "isDirectory"), v8::Boolean::New(isolate, S_ISDIR(st.st_mode)));
+      statObj->Set(v8::String::NewFromUtf8(isolate, "isSymbolicLink"), v8::Boolean::New(isolate, isSymbolic));
+      statObj->Set(v8::String::NewFromUtf8(isolate, "size"), v8::Number::New(isolate, (double)st.st_size));
+      statObj->Set(v8::String::NewFromUtf8(isolate, "mtime"), v8::Date::New(isolate, (double)st.st_mtime * 1000));
+      callWithResult(isolate, callback, v8::Null(isolate), statObj);
+    };
+    PipeModule::nextFrame(nffn);
+  });
+}
+
+//
+// Read streams
+//
+// A fixed set of chunk buffers (the read-ahead) is filled in file order on the worker pool,
+// one read in flight per stream. A filled chunk is handed to js with the next frame as a
+// Uint8Array over a reused ArrayBuffer, after the callback returns the buffer is free to be
+// refilled. Memory use is chunkSize * readAhead, independent of the file size.
+//
+// The file, the buffers and the read position live in ReadState, shared with the read jobs.
+// The ReadStream itself (the js side) is only owned by the factory, so it is always released
+// on the script thread. It holds on to the js callback only while chunks are on their way,
+// a paused or finished stream that is no longer referenced from js can be collected.
+
+class ReadState {
+  public:
+  ReadState( int fd, size_t chunkSize, int readAhead ) : mFd(fd), mChunkSize(chunkSize) {
+    mBuffers.resize(readAhead);
+    for(int i = 0; i < readAhead; i++){
+      mBuffers[i].resize(chunkSize);
+      mFree.push_back(i);
+    }
+  }
+  
+  ~ReadState(){
+    if(mFd >= 0) ::close(mFd);
+  }
+  
+  // Claims the next free buffer for a read, if none is in flight
+  bool next( int* index ){
+    std::lock_guard<std::mutex> lck( _mutex );
+    if(mReading || mPaused || mClosed || mEof || mFree.empty()) return false;
+    mReading = true;
+    *index = mFree.front();
+    mFree.pop_front();
+    return true;
+  }
+  
+  // Worker thread, reads into the claimed buffer and then ahead while buffers are free.
+  // The buffer belongs to the read while mReading is set, the lock is not held during pread,
+  // so pausing or closing from the script thread never waits for the disk.
+  template<class Deliver>
+  void read( int index, Deliver deliver ){
+    do {
+      int fd;
+      off_t offset;
       {
-        std::ostringstream contents;
-        contents << in.rdbuf();
-        jsFileContents = contents.str();
-        in.close();
-      }
-    } catch(std::exception &e) {
-      std::string err = "Error: ";
-      err.append(e.what());
-      isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, err.c_str())));
+        std::lock_guard<std::mutex> lck( _mutex );
+        if(mClosed){
+          finishClosed(index);
+          return;
+        }
+        fd = mFd;
+        offset = mOffset;
+      }
+      
+      ssize_t n;
+      int err = 0;
+      do {
+        n = pread(fd, mBuffers[index].data(), mChunkSize, offset);
+      } while(n < 0 && errno == EINTR);
+      if(n < 0){
+        err = errno;
+        n = 0;
+      }
+      bool eof = err || n == 0;
+      
+      {
+        std::lock_guard<std::mutex> lck( _mutex );
+        if(mClosed){
+          finishClosed(index);
+          return;
+        }
+        mReading = false;
+        mOffset += n;
+        mEof = eof;
+        mQueued++;
+      }
+      
+      deliver(index, (size_t)n, eof, err);
+      if(eof) return;
+    } while(next(&index));
+  }
+  
+  // Script thread, a delivered buffer can be refilled
+  void release( int index ){
+    std::lock_guard<std::mutex> lck( _mutex );
+    mQueued--;
+    mFree.push_back(index);
+  }
+  
+  void setPaused( bool paused ){
+    std::lock_guard<std::mutex> lck( _mutex );
+    mPaused = paused;
+  }
+  
+  // A read in flight closes the file when it returns
+  void close(){
+    std::lock_guard<std::mutex> lck( _mutex );
+    mClosed = true;
+    if(!mReading && mFd >= 0){
+      ::close(mFd);
+      mFd = -1;
+    }
+  }
+  
+  bool isClosed(){
+    std::lock_guard<std::mutex> lck( _mutex );
+    return mClosed;
+  }
+  
+  // Nothing is read or waiting for js and nothing will be without resume()
+  bool isIdle(){
+    std::lock_guard<std::mutex> lck( _mutex );
+    return !mReading && mQueued == 0 && (mPaused || mEof || mClosed);
+  }
+  
+  uint8_t* data( int index ){
+    return mBuffers[index].data();
+  }
+  
+  size_t getChunkSize() const {
+    return mChunkSize;
+  }
+  
+  private:
+  // With the lock held
+  void finishClosed( int index ){
+    mReading = false;
+    mFree.push_back(index);
+    if(mFd >= 0){
+      ::close(mFd);
+      mFd = -1;
+    }
+  }
+  
+  std::mutex _mutex;
+  int mFd;
+  size_t mChunkSize;
+  off_t mOffset = 0;
+  bool mReading = false;
+  bool mPaused = false;
+  bool mClosed = false;
+  bool mEof = false;
+  int mQueued = 0;
+  std::vector<std::vector<uint8_t>> mBuffers;
+  std::deque<int> mFree;
+};
+
+class ReadStream : public std::enable_shared_from_this<ReadStream> {
+  public:
+  ReadStream( int fd, size_t chunkSize, int readAhead ) : mState(new ReadState(fd, chunkSize, readAhead)) {
+    mArrays.resize(readAhead);
+  }
+  
+  // Removed or collected without close()
+  ~ReadStream(){
+    v8::Isolate* isolate = v8::Isolate::GetCurrent();
+    if(isolate){
+      dispose(isolate);
+    } else {
+      mState->close();
+    }
+  }
+  
+  // Script thread, onRead(err, chunk, eof)
+  void start( Isolate* isolate, Local<Function> onRead ){
+    mOnRead.Reset(isolate, onRead);
+    pump();
+  }
+  
+  // Resuming takes the callback again, it is let go while paused
+  void setPaused( Isolate* isolate, bool paused, Local<Value> onRead ){
+    mState->setPaused(paused);
+    if(paused){
+      releaseIfIdle();
       return;
     }
+    if(onRead->IsFunction()){
+      mOnRead.Reset(isolate, onRead.As<Function>());
+    }
+    pump();
+  }
+  
+  // Script thread, releases the js side (persistents), the stream is not usable afterwards.
+  // Chunks handed out before are neutered.
+  void dispose( Isolate* isolate ){
+    mState->close();
+    mOnRead.Reset();
+    
+    v8::HandleScope scope(isolate);
+    for(v8::Persistent<v8::ArrayBuffer>& array : mArrays){
+      if(!array.IsEmpty()){
+        Local<ArrayBuffer> buffer = Local<ArrayBuffer>::New(isolate, array);
+        if(buffer->IsNeuterable()) buffer->Neuter();
+        array.Reset();
+      }
+    }
   }
   
-  args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, jsFileContents.c_str()));
+  private:
+  // Starts reading if a buffer is free and no read is in flight
+  void pump(){
+    int index;
+    if(!mState->next(&index)) return;
+    
+    std::shared_ptr<ReadState> state = mState;
+    std::weak_ptr<ReadStream> weakSelf = shared_from_this();
+    PipeModule::getWorkerPool().submit([state, weakSelf, index](){
+      state->read(index, [weakSelf](int index, size_t length, bool eof, int err){
+        NextFrameFn nffn(new NextFrameFnHolder());
+        nffn->complete = [weakSelf, index, length, eof, err](Isolate* isolate, Local<Function> fn){
+          std::shared_ptr<ReadStream> self = weakSelf.lock();
+          if(self){
+            self->deliver(isolate, index, length, eof, err);
+          }
+        };
+        PipeModule::nextFrame(nffn);
+      });
+    });
+  }
   
-  return;
+  // Script thread
+  void deliver( Isolate* isolate, int index, size_t length, bool eof, int err ){
+    if(!mState->isClosed() && !mOnRead.IsEmpty()){
+      if(mArrays[index].IsEmpty()){
+        mArrays[index].Reset(isolate, ArrayBuffer::New(isolate, mState->data(index), mState->getChunkSize()));
+      }
+      
+      Local<Function> onRead = Local<Function>::New(isolate, mOnRead);
+      Local<Value> argv[3] = {
+        err ? v8::Exception::Error(v8::String::NewFromUtf8(isolate, strerror(err))) : v8::Null(isolate).As<Value>(),
+        length > 0 ? Uint8Array::New(Local<ArrayBuffer>::New(isolate, mArrays[index]), 0, length).As<Value>() : v8::Undefined(isolate).As<Value>(),
+        v8::Boolean::New(isolate, eof)
+      };
+      onRead->Call(onRead->CreationContext()->Global(), 3, argv);
+    }
+    
+    mState->release(index);
+    pump();
+    releaseIfIdle();
+  }
+  
+  void releaseIfIdle(){
+    if(mState->isIdle()){
+      mOnRead.Reset();
+    }
+  }
+  
+  std::shared_ptr<ReadState> mState;
+  v8::Persistent<v8::Function> mOnRead;
+  std::vector<v8::Persistent<v8::ArrayBuffer>> mArrays;
+};
+
+/**
+ * createReadStream( handle, path, chunkSize, readAhead, onRead )
+ * onRead(err, chunk, eof) is called per chunk, chunk is only valid during the call.
+ */
+void createReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[4]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "createReadStream needs a read callback")));
+    return;
+  }
+  
+  String::Utf8Value path(args[1]->ToString());
+  double chunkSize = args[2]->NumberValue();
+  int32_t readAhead = args[3]->Int32Value();
+  
+  if(!(chunkSize >= 1) || chunkSize > (1 << 30) || readAhead < 1 || readAhead > 64){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Invalid chunkSize or readAhead")));
+    return;
+  }
+  
+  int fd = open(*path, O_RDONLY);
+  if(fd < 0){
+    isolate->ThrowException(fileError(isolate, errno, *path));
+    return;
+  }
+  
+  std::shared_ptr<ReadStream> stream(new ReadStream(fd, (size_t)chunkSize, readAhead));
+  StaticFactory::put<ReadStream>( isolate, stream, args[0]->ToObject() );
+  stream->start(isolate, args[4].As<Function>());
+}
+
+/**
+ * pauseReadStream( handle, paused, onRead )
+ * onRead is taken again on resume, a paused stream does not keep it alive.
+ */
+void pauseReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  std::shared_ptr<ReadStream> stream = StaticFactory::get<ReadStream>(args[0]);
+  if(!stream){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "ReadStream does not exist")));
+    return;
+  }
+  
+  stream->setPaused(isolate, args[1]->BooleanValue(), args[2]);
+}
+
+/**
+ * closeReadStream( handle )
+ * Stops reading, chunks already queued are not delivered.
+ */
+void closeReadStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  std::shared_ptr<ReadStream> stream = StaticFactory::get<ReadStream>(args[0]);
+  if(stream){
+    stream->dispose(isolate);
+    StaticFactory::remove<ReadStream>(isolate, args[0]);
+  }
+}
+
+//
+// Watch
+// Events from the watcher thread are collected and handed to js with the next frame,
+// repeated events for the same file within a frame are delivered once.
+class FileWatch {
+  public:
+  FileWatch() : mEvents(new Events()) {}
+  
+  ~FileWatch(){
+    stop();
+  }
+  
+  // Script thread, onChange(eventType, filename)
+  bool start( Isolate* isolate, Local<Function> onChange, const fs::path& path, std::string* error ){
+    std::weak_ptr<Events> weakEvents = mEvents;
+    
+    // Set once, the completion is only ever re-queued
+    mEvents->completion->v8Fn.Reset(isolate, onChange);
+    mEvents->completion->complete = [weakEvents](Isolate* isolate, Local<Function> onChange){
+      std::shared_ptr<Events> events = weakEvents.lock();
+      if(events){
+        events->deliver(isolate, onChange);
+      }
+    };
+    
+    // The watcher callback owns the event queue, never the watch,
+    // so the watch is only ever released (and removed) on the script thread
+    std::shared_ptr<Events> events = mEvents;
+    mId = FileWatcher::add(path, [events](const std::string& event, const std::string& filename){
+      events->queue(event, filename);
+    }, error);
+    return mId != 0;
+  }
+  
+  void stop(){
+    if(mId){
+      FileWatcher::remove(mId);
+      mId = 0;
+    }
+  }
+  
+  // Script thread, events still queued are dropped
+  void dispose(){
+    stop();
+    std::lock_guard<std::mutex> lck( mEvents->mutex );
+    mEvents->pending.clear();
+    mEvents->closed = true;
+    mEvents->completion->v8Fn.Reset();
+  }
+  
+  private:
+  struct Events {
+    Events() : completion(new NextFrameFnHolder()) {
+      completion->repeat = true;
+    }
+    
+    // Watcher thread
+    void queue( const std::string& event, const std::string& filename ){
+      std::lock_guard<std::mutex> lck( mutex );
+      if(closed) return;
+      for(auto& entry : pending){
+        if(entry.first == event && entry.second == filename) return;
+      }
+      pending.push_back(std::make_pair(event, filename));
+      
+      if(!queued){
+        queued = true;
+        PipeModule::nextFrame(completion);
+      }
+    }
+    
+    // Script thread
+    void deliver( Isolate* isolate, Local<Function> onChange ){
+      std::vector<std::pair<std::string, std::string>> entries;
+      {
+        std::lock_guard<std::mutex> lck( mutex );
+        entries.swap(pending);
+        queued = false;
+        if(closed) return;
+      }
+      
+      for(auto& entry : entries){
+        Local<Value> argv[2] = {
+          v8::String::NewFromUtf8(isolate, entry.first.c_str()),
+          v8::String::NewFromUtf8(isolate, entry.second.c_str())
+        };
+        onChange->Call(onChange->CreationContext()->Global(), 2, argv);
+      }
+    }
+    
+    std::mutex mutex;
+    bool queued = false;
+    bool closed = false;
+    std::vector<std::pair<std::string, std::string>> pending;
+    NextFrameFn completion;
+  };
+  
+  uint32_t mId = 0;
+  std::shared_ptr<Events> mEvents;
+};
+
+/**
+ * watch( handle, path, onChange )
+ * onChange(eventType, filename) with the next frame, eventType is "change" or "rename".
+ */
+void watch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[2]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "watch needs a change callback")));
+    return;
+  }
+  
+  String::Utf8Value path(args[1]->ToString());
+  
+  std::shared_ptr<FileWatch> watcher(new FileWatch());
+  std::string error;
+  if(!watcher->start(isolate, args[2].As<Function>(), fs::path(*path), &error)){
+    watcher->dispose();
+    std::string msg = error + ", watch '" + *path + "'";
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, msg.c_str())));
+    return;
+  }
+  
+  StaticFactory::put<FileWatch>( isolate, watcher, args[0]->ToObject() );
+}
+
+/**
+ * unwatch( handle )
+ */
+void unwatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  std::shared_ptr<FileWatch> watcher = StaticFactory::get<FileWatch>(args[0]);
+  if(watcher){
+    watcher->dispose();
+    StaticFactory::remove<FileWatch>(isolate, args[0]);
+  }
+}
+
+//
+// Module resolution
+//
+// Directory listings are cached and only re-read when the directory mtime changed,
+// checked at most once per resolveModule call. A candidate file is then a hash lookup
+// in its directory listing instead of a stat call.
+
+struct DirListing {
+  bool exists = false;
+  std::time_t mtime = 0;
+  std::time_t listedAt = 0;
+  uint32_t checkedIn = 0;       // resolve call the mtime was last checked in
+  std::unordered_map<std::string, bool> entries; // name -> is directory
+  
+  // package.json "main", read on demand
+  bool packageRead = false;
+  std::time_t packageMtime = 0;
+  std::string packageMain;
+};
+
+static std::unordered_map<std::string, DirListing> sDirCache;
+static uint32_t sResolveCall = 0;
+
+static DirListing& listDirectory( const std::string& dir ){
+  DirListing& listing = sDirCache[dir];
+  if(listing.checkedIn == sResolveCall){
+    return listing;
+  }
+  listing.checkedIn = sResolveCall;
+  
+  boost::system::error_code ec;
+  std::time_t mtime = fs::last_write_time(fs::path(dir), ec);
+  if(ec){
+    listing = DirListing();
+    listing.checkedIn = sResolveCall;
+    return listing;
+  }
+  
+  // mtime has a resolution of one second, a listing taken within the second of a change may be incomplete
+  if(listing.exists && listing.mtime == mtime && mtime < listing.listedAt - 1){
+    return listing;
+  }
+  
+  listing.exists = true;
+  listing.mtime = mtime;
+  listing.listedAt = std::time(nullptr);
+  listing.entries.clear();
+  listing.packageRead = false;
+  
+  for(fs::directory_iterator it(fs::path(dir), ec), end; !ec && it != end; it.increment(ec)){
+    boost::system::error_code statEc;
+    listing.entries[it->path().filename().string()] = fs::is_directory(it->path(), statEc);
+  }
+  
+  return listing;
+}
+
+static bool isFile( const std::string& file ){
+  size_t slash = file.rfind('/');
+  if(slash == std::string::npos){
+    return false;
+  }
+  DirListing& listing = listDirectory(slash == 0 ? "/" : file.substr(0, slash));
+  auto it = listing.entries.find(file.substr(slash + 1));
+  return it != listing.entries.end() && !it->second;
+}
+
+// Absolute path with "." and ".." segments and duplicate slashes removed, like path.resolve
+static std::string resolvePath( const std::string& base, const std::string& request ){
+  std::string joined;
+  if(!request.empty() && request[0] == '/'){
+    joined = request;
+  } else {
+    joined = base.empty() || base[0] != '/' ? (fs::current_path() / base).string() : base;
+    joined += "/" + request;
+  }
+  
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while(start <= joined.size()){
+    size_t end = joined.find('/', start);
+    if(end == std::string::npos) end = joined.size();
+    std::string part = joined.substr(start, end - start);
+    if(part == ".."){
+      if(!parts.empty()) parts.pop_back();
+    } else if(!part.empty() && part != "."){
+      parts.push_back(part);
+    }
+    start = end + 1;
+  }
+  
+  std::string result;
+  for(const std::string& part : parts){
+    result += "/" + part;
+  }
+  return result.empty() ? "/" : result;
+}
+
+static std::string realPath( const std::string& file ){
+  boost::system::error_code ec;
+  fs::path real = fs::canonical(fs::path(file), ec);
+  return ec ? file : real.string();
+}
+
+static bool tryExtensions( const std::string& base, const std::vector<std::string>& exts, std::string* result ){
+  for(const std::string& ext : exts){
+    if(isFile(base + ext)){
+      *result = realPath(base + ext);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads "main" from dir/package.json, false if there is none. Sets error if it cannot be read or parsed.
+static bool readPackageMain( v8::Isolate* isolate, const std::string& dir, std::string* main, std::string* error ){
+  DirListing& listing = listDirectory(dir);
+  if(!isFile(dir + "/package.json")){
+    return false;
+  }
+  
+  std::string jsonPath = dir + "/package.json";
+  boost::system::error_code ec;
+  std::time_t mtime = fs::last_write_time(fs::path(jsonPath), ec);
+  if(!listing.packageRead || listing.packageMtime != mtime){
+    MappedFile file;
+    if(!file.map(jsonPath.c_str())){
+      *error = "Error loading " + jsonPath + ": " + strerror(errno);
+      return false;
+    }
+    
+    v8::TryCatch tryCatch;
+    Local<Value> json = v8::JSON::Parse(v8::String::NewFromUtf8(isolate, (const char*)file.data,
+      v8::String::kNormalString, (int)file.size));
+    if(tryCatch.HasCaught() || json.IsEmpty()){
+      *error = "Error parsing " + jsonPath;
+      if(tryCatch.HasCaught()){
+        v8::String::Utf8Value msg(tryCatch.Exception());
+        error->append(": ");
+        error->append(*msg);
+      }
+      return false;
+    }
+    
+    listing.packageMain.clear();
+    if(json->IsObject()){
+      Local<Value> mainValue = json.As<Object>()->Get(v8::String::NewFromUtf8(isolate, "main"));
+      if(mainValue->IsString()){
+        v8::String::Utf8Value mainStr(mainValue);
+        listing.packageMain = *mainStr;
+      }
+    }
+    listing.packageRead = true;
+    listing.packageMtime = mtime;
+  }
+  
+  *main = listing.packageMain;
+  return !main->empty();
+}
+
+/**
+ * Resolves a module request the way Module._findPath does, in one call.
+ * For each path: path/request, path/request.<ext>, the package.json main of path/request
+ * (as file, with extensions or its index.<ext>) and path/request/index.<ext>.
+ * args: request, paths, exts
+ * @return string the real path of the module file or false
+ */
+void resolveModule(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  if(!args[1]->IsArray() || !args[2]->IsArray()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "resolveModule needs a paths and an extensions array")));
+    return;
+  }
+  
+  String::Utf8Value requestStr(args[0]->ToString());
+  std::string request(*requestStr);
+  
+  Local<Array> pathsArr = args[1].As<Array>();
+  Local<Array> extsArr = args[2].As<Array>();
+  
+  std::vector<std::string> paths;
+  if(!request.empty() && request[0] == '/'){
+    paths.push_back("");
+  } else {
+    for(uint32_t i = 0; i < pathsArr->Length(); i++){
+      String::Utf8Value p(pathsArr->Get(i)->ToString());
+      paths.push_back(*p);
+    }
+  }
+  
+  std::vector<std::string> exts;
+  for(uint32_t i = 0; i < extsArr->Length(); i++){
+    String::Utf8Value e(extsArr->Get(i)->ToString());
+    exts.push_back(*e);
+  }
+  
+  bool trailingSlash = !request.empty() && request[request.size() - 1] == '/';
+  
+  // New call, directory mtimes are checked again (0 is never a valid call)
+  if(++sResolveCall == 0) sResolveCall = 1;
+  
+  std::string filename;
+  for(const std::string& path : paths){
+    std::string basePath = resolvePath(path, request);
+    
+    if(!trailingSlash){
+      if(isFile(basePath)){
+        filename = realPath(basePath);
+        break;
+      }
+      if(tryExtensions(basePath, exts, &filename)){
+        break;
+      }
+    }
+    
+    std::string main;
+    std::string error;
+    if(readPackageMain(isolate, basePath, &main, &error)){
+      std::string mainPath = resolvePath(basePath, main);
+      if(isFile(mainPath)){
+        filename = realPath(mainPath);
+        break;
+      }
+      if(tryExtensions(mainPath, exts, &filename) || tryExtensions(mainPath + "/index", exts, &filename)){
+        break;
+      }
+    }
+    
+    if(!error.empty()){
+      isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, error.c_str())));
+      return;
+    }
+    
+    if(tryExtensions(basePath + "/index", exts, &filename)){
+      break;
+    }
+  }
+  
+  if(filename.empty()){
+    args.GetReturnValue().Set(v8::False(isolate));
+  } else {
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, filename.c_str()));
+  }
 }
 
 /**
@@ -126,6 +1091,15 @@ void FSModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "existsSync"), v8::FunctionTemplate::New(getIsolate(), existsSync));
   fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "readFileSync"), v8::FunctionTemplate::New(getIsolate(), readFileSync));
   fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "statSync"), v8::FunctionTemplate::New(getIsolate(), statSync));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "resolveModule"), v8::FunctionTemplate::New(getIsolate(), resolveModule));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "readFile"), v8::FunctionTemplate::New(getIsolate(), readFile));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "writeFile"), v8::FunctionTemplate::New(getIsolate(), writeFile));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "stat"), v8::FunctionTemplate::New(getIsolate(), statAsync));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createReadStream"), v8::FunctionTemplate::New(getIsolate(), createReadStream));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "pauseReadStream"), v8::FunctionTemplate::New(getIsolate(), pauseReadStream));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "closeReadStream"), v8::FunctionTemplate::New(getIsolate(), closeReadStream));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "watch"), v8::FunctionTemplate::New(getIsolate(), watch));
+  fsTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "unwatch"), v8::FunctionTemplate::New(getIsolate(), unwatch));
   
   // Expose global fs object
   global->Set(v8::String::NewFromUtf8(getIsolate(), "_fs"), fsTemplate);
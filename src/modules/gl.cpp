@@ -46,6 +46,8 @@ vec2 GLModule::bufVec2f_2;
 vec3 GLModule::bufVec3f_1;
 vec3 GLModule::bufVec3f_2;
 quat GLModule::bufQuat_1;
+std::vector<float>* GLModule::sRecordTarget = nullptr;
+std::atomic<const char*> GLModule::sUnrecordedUse(nullptr);
 ColorA GLModule::sBufColorA_1;
 Color GLModule::sBufColor_1;
 
@@ -53,6 +55,7 @@ Color GLModule::sBufColor_1;
  * drawLine( sx, sy, ex, ey );
  */
 void GLModule::drawLine(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawLine");
   
   // 2D Line
   if(args.Length() == 4){
@@ -84,6 +87,7 @@ void GLModule::drawLine(const v8::FunctionCallbackInfo<v8::Value>& args) {
  * drawSolidCircle( cx, cy, radius );
  */
 void GLModule::drawSolidCircle(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawSolidCircle");
   
   bufVec2f_1.x = args[0]->NumberValue();
   bufVec2f_1.y = args[1]->NumberValue();
@@ -98,6 +102,8 @@ void GLModule::drawSolidCircle(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::pushMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.pushMatrices");
+  
   gl::pushMatrices();
   return;
 }
@@ -106,6 +112,8 @@ void GLModule::pushMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::popMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.popMatrices");
+  
   gl::popMatrices();
   return;
 }
@@ -114,6 +122,8 @@ void GLModule::popMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::begin(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.begin");
+  
   gl::begin(args[0]->NumberValue());
   return;
 }
@@ -122,6 +132,7 @@ void GLModule::begin(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::end(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.end");
   gl::end();
   return;
 }
@@ -130,6 +141,8 @@ void GLModule::end(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::enable(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enable");
+  
   GLenum num = args[0]->ToUint32()->Value();
   gl::enable(num);
   return;
@@ -139,6 +152,8 @@ void GLModule::enable(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::disable(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.disable");
+  
   GLenum num = args[0]->ToUint32()->Value();
   gl::disable(num);
   return;
@@ -148,6 +163,8 @@ void GLModule::disable(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::translate(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.translate");
+  
   if(args.Length() == 2){
     gl::translate(vec2(args[0]->NumberValue(), args[1]->NumberValue()));
     return;
@@ -165,6 +182,8 @@ void GLModule::translate(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::scale(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.scale");
+  
   if(args.Length() == 2){
     bufVec2f_1.x = args[0]->NumberValue();
     bufVec2f_1.y = args[1]->NumberValue();
@@ -183,6 +202,8 @@ void GLModule::scale(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::rotate(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.rotate");
+  
   if(args.Length() >= 3){
     
     gl::rotate(quat(
@@ -204,6 +225,8 @@ void GLModule::rotate(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::vertex(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.vertex");
+  
   if(args.Length() == 2){
     bufVec2f_1.x = args[0]->NumberValue();
     bufVec2f_1.y = args[1]->NumberValue();
@@ -222,6 +245,8 @@ void GLModule::vertex(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::color(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.color");
+  
   if(args.Length() == 3){
     gl::color(args[0]->NumberValue(), args[1]->NumberValue(), args[2]->NumberValue());
     return;
@@ -235,6 +260,8 @@ void GLModule::color(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::enableWireframe(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enableWireframe");
+  
   gl::enableWireframe();
   return;
 }
@@ -243,6 +270,8 @@ void GLModule::enableWireframe(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::disableWireframe(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.disableWireframe");
+  
   gl::disableWireframe();
   return;
 }
@@ -251,6 +280,8 @@ void GLModule::disableWireframe(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::enableDepthRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enableDepthRead");
+  
   gl::enableDepthRead();
   return;
 }
@@ -259,6 +290,8 @@ void GLModule::enableDepthRead(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::disableDepthRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.disableDepthRead");
+  
   gl::disableDepthRead();
   return;
 }
@@ -267,6 +300,8 @@ void GLModule::disableDepthRead(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::enableDepthWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enableDepthWrite");
+  
   gl::enableDepthWrite();
   return;
 }
@@ -275,6 +310,8 @@ void GLModule::enableDepthWrite(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::disableDepthWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.disableDepthWrite");
+  
   gl::disableDepthWrite();
   return;
 }
@@ -283,6 +320,8 @@ void GLModule::disableDepthWrite(const v8::FunctionCallbackInfo<v8::Value>& args
  *
  */
 void GLModule::enableDepth(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enableDepth");
+  
   gl::enableDepthRead();
   gl::enableDepthWrite();
   return;
@@ -292,6 +331,8 @@ void GLModule::enableDepth(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::disableDepth(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.disableDepth");
+  
   gl::disableDepthRead();
   gl::disableDepthWrite();
   return;
@@ -326,6 +367,7 @@ void GLModule::isVerticalSyncEnabled(const v8::FunctionCallbackInfo<v8::Value>&
  *
  */
 void GLModule::drawCube(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawCube");
   
   bufVec3f_1.x = args[0]->NumberValue();
   bufVec3f_1.y = args[1]->NumberValue();
@@ -344,6 +386,7 @@ void GLModule::drawCube(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::drawColorCube(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawColorCube");
   
   bufVec3f_1.x = args[0]->NumberValue();
   bufVec3f_1.y = args[1]->NumberValue();
@@ -362,6 +405,7 @@ void GLModule::drawColorCube(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::drawSphere(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawSphere");
   bufVec3f_1.x = args[0]->NumberValue();
   bufVec3f_1.y = args[1]->NumberValue();
   bufVec3f_1.z = args[2]->NumberValue();
@@ -376,6 +420,8 @@ void GLModule::drawSphere(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::setMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.setMatrices");
+  
   if(args[0]->IsUint32()){
     uint32_t id = args[0]->ToUint32()->Value();
     std::shared_ptr<CameraPersp> cam = StaticFactory::get<CameraPersp>(id);
@@ -402,6 +448,8 @@ void GLModule::setMatrices(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::setMatricesWindow(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.setMatricesWindow");
+  
   if(args.Length() == 2) {
     gl::setMatricesWindow(args[0]->IntegerValue(), args[1]->IntegerValue());
   }
@@ -412,6 +460,8 @@ void GLModule::setMatricesWindow(const v8::FunctionCallbackInfo<v8::Value>& args
  *
  */
 void GLModule::setMatricesWindowPersp(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.setMatricesWindowPersp");
+  
   if(args.Length() == 2) {
     gl::setMatricesWindowPersp(args[0]->IntegerValue(), args[1]->IntegerValue());
   }
@@ -422,6 +472,8 @@ void GLModule::setMatricesWindowPersp(const v8::FunctionCallbackInfo<v8::Value>&
  *
  */
 void GLModule::setModelMatrix(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.setModelMatrix");
+  
   if(args[0]->IsUint32()){
     uint32_t id = args[0]->ToUint32()->Value();
     std::shared_ptr<mat4> mat = StaticFactory::get<mat4>(id);
@@ -449,6 +501,7 @@ void GLModule::setModelMatrix(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::clear(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.clear");
   if(args.Length() >= 3) {
     sBufColor_1.r = args[0]->ToNumber()->Value();
     sBufColor_1.g = args[1]->ToNumber()->Value();
@@ -465,6 +518,8 @@ void GLModule::clear(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::multModelMatrix(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.multModelMatrix");
+  
   uint32_t id = args[0]->ToUint32()->Value();
   std::shared_ptr<mat4> matrix = StaticFactory::get<mat4>(id);
   
@@ -483,6 +538,8 @@ void GLModule::multModelMatrix(const v8::FunctionCallbackInfo<v8::Value>& args)
  *
  */
 void GLModule::pushViewport(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.pushViewport");
+  
   if(args.Length() > 3) {
     return gl::pushViewport(
       vec2(
@@ -504,6 +561,8 @@ void GLModule::pushViewport(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::popViewport(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.popViewport");
+  
   gl::popViewport();
   return;
 }
@@ -512,6 +571,7 @@ void GLModule::popViewport(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::drawTexture(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawTexture");
   
   // gl::draw(const Texture2dRef &texture, const Rectf &dstRect)
   if(args.Length() == 5){
@@ -543,6 +603,8 @@ void GLModule::drawTexture(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::enableVertexAttribArray(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.enableVertexAttribArray");
+  
   gl::enableVertexAttribArray( args[0]->ToInt32()->Value() );
   return;
 }
@@ -551,6 +613,8 @@ void GLModule::enableVertexAttribArray(const v8::FunctionCallbackInfo<v8::Value>
  *
  */
 void GLModule::vertexAttribPointer(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.vertexAttribPointer");
+  
   gl::vertexAttribPointer(
     args[0]->ToUint32()->Value(),
     args[1]->ToUint32()->Value(),
@@ -566,6 +630,8 @@ void GLModule::vertexAttribPointer(const v8::FunctionCallbackInfo<v8::Value>& ar
  * TODO: Move to Context binding when implemented
  */
 void GLModule::pushBoolState(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.pushBoolState");
+  
   gl::context()->pushBoolState(
     args[0]->IntegerValue(),
     args[1]->BooleanValue()
@@ -577,6 +643,8 @@ void GLModule::pushBoolState(const v8::FunctionCallbackInfo<v8::Value>& args) {
  * TODO: Move to Context binding when implemented
  */
 void GLModule::popBoolState(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.popBoolState");
+  
   gl::context()->popBoolState(
     args[0]->IntegerValue()
   );
@@ -587,6 +655,8 @@ void GLModule::popBoolState(const v8::FunctionCallbackInfo<v8::Value>& args) {
  * TODO: Move to Context binding when implemented
  */
 void GLModule::setDefaultShaderVars(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.setDefaultShaderVars");
+  
   gl::context()->setDefaultShaderVars();
   return;
 }
@@ -595,6 +665,8 @@ void GLModule::setDefaultShaderVars(const v8::FunctionCallbackInfo<v8::Value>& a
  *
  */
 void GLModule::bindBufferBase(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.bindBufferBase");
+  
   
   uint32_t id = args[2]->IntegerValue();
   
@@ -623,6 +695,8 @@ void GLModule::bindBufferBase(const v8::FunctionCallbackInfo<v8::Value>& args) {
  *
  */
 void GLModule::beginTransformFeedback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.beginTransformFeedback");
+  
   gl::beginTransformFeedback( args[0]->IntegerValue() );
   return;
 }
@@ -631,6 +705,8 @@ void GLModule::beginTransformFeedback(const v8::FunctionCallbackInfo<v8::Value>&
  *
  */
 void GLModule::endTransformFeedback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.endTransformFeedback");
+  
   gl::endTransformFeedback();
   return;
 }
@@ -639,6 +715,7 @@ void GLModule::endTransformFeedback(const v8::FunctionCallbackInfo<v8::Value>& a
  *
  */
 void GLModule::drawArrays(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  checkUnrecorded("gl.drawArrays");
   gl::drawArrays(
     args[0]->IntegerValue(),
     args[1]->IntegerValue(),
@@ -647,6 +724,188 @@ void GLModule::drawArrays(const v8::FunctionCallbackInfo<v8::Value>& args) {
   return;
 }
 
+/**
+ * Decodes and executes count floats of commands (see GLCommand).
+ * Returns 0 on success, 1 for a truncated and 2 for an unknown command,
+ * with the offending float index in errorAt.
+ * Uses no static buffers, so it can replay recorded frames on the render thread.
+ */
+int GLModule::execute( const float* cmd, size_t count, size_t* errorAt ) {
+  const float* begin = cmd;
+  const float* end = cmd + count;
+  vec3 v1, v2;
+
+  // Number of operands following each opcode, checked against the buffer end
+  #define CJS_OPERANDS(n) if(cmd + n > end) { error = 1; break; }
+
+  int error = 0;
+  while(cmd < end && !error){
+    uint32_t op = (uint32_t)*cmd++;
+
+    switch(op){
+      case CJS_GL_END_OF_BUFFER:
+        cmd = end;
+        break;
+      case CJS_GL_PUSH_MATRICES:
+        gl::pushMatrices();
+        break;
+      case CJS_GL_POP_MATRICES:
+        gl::popMatrices();
+        break;
+      case CJS_GL_TRANSLATE:
+        CJS_OPERANDS(3);
+        gl::translate(vec3(cmd[0], cmd[1], cmd[2]));
+        cmd += 3;
+        break;
+      case CJS_GL_SCALE:
+        CJS_OPERANDS(3);
+        gl::scale(vec3(cmd[0], cmd[1], cmd[2]));
+        cmd += 3;
+        break;
+      case CJS_GL_ROTATE:
+        CJS_OPERANDS(1);
+        gl::rotate(cmd[0]);
+        cmd += 1;
+        break;
+      case CJS_GL_ROTATE_QUAT:
+        CJS_OPERANDS(4);
+        gl::rotate(quat(cmd[0], cmd[1], cmd[2], cmd[3]));
+        cmd += 4;
+        break;
+      case CJS_GL_COLOR:
+        CJS_OPERANDS(4);
+        gl::color(cmd[0], cmd[1], cmd[2], cmd[3]);
+        cmd += 4;
+        break;
+      case CJS_GL_ENABLE:
+        CJS_OPERANDS(1);
+        gl::enable((GLenum)cmd[0]);
+        cmd += 1;
+        break;
+      case CJS_GL_DISABLE:
+        CJS_OPERANDS(1);
+        gl::disable((GLenum)cmd[0]);
+        cmd += 1;
+        break;
+      case CJS_GL_ENABLE_DEPTH_READ:
+        gl::enableDepthRead();
+        break;
+      case CJS_GL_DISABLE_DEPTH_READ:
+        gl::disableDepthRead();
+        break;
+      case CJS_GL_ENABLE_DEPTH_WRITE:
+        gl::enableDepthWrite();
+        break;
+      case CJS_GL_DISABLE_DEPTH_WRITE:
+        gl::disableDepthWrite();
+        break;
+      case CJS_GL_CLEAR:
+        CJS_OPERANDS(4);
+        gl::clear(ColorA(cmd[0], cmd[1], cmd[2], cmd[3]));
+        cmd += 4;
+        break;
+      case CJS_GL_DRAW_CUBE:
+        CJS_OPERANDS(6);
+        v1 = vec3(cmd[0], cmd[1], cmd[2]);
+        v2 = vec3(cmd[3], cmd[4], cmd[5]);
+        gl::drawCube(v1, v2);
+        cmd += 6;
+        break;
+      case CJS_GL_DRAW_COLOR_CUBE:
+        CJS_OPERANDS(6);
+        v1 = vec3(cmd[0], cmd[1], cmd[2]);
+        v2 = vec3(cmd[3], cmd[4], cmd[5]);
+        gl::drawColorCube(v1, v2);
+        cmd += 6;
+        break;
+      case CJS_GL_DRAW_SPHERE:
+        CJS_OPERANDS(5);
+        gl::drawSphere(vec3(cmd[0], cmd[1], cmd[2]), cmd[3], (int)cmd[4]);
+        cmd += 5;
+        break;
+      case CJS_GL_DRAW_LINE:
+        CJS_OPERANDS(6);
+        v1 = vec3(cmd[0], cmd[1], cmd[2]);
+        v2 = vec3(cmd[3], cmd[4], cmd[5]);
+        gl::drawLine(v1, v2);
+        cmd += 6;
+        break;
+      case CJS_GL_DRAW_SOLID_CIRCLE:
+        CJS_OPERANDS(3);
+        gl::drawSolidCircle(vec2(cmd[0], cmd[1]), cmd[2]);
+        cmd += 3;
+        break;
+      case CJS_GL_BEGIN:
+        CJS_OPERANDS(1);
+        gl::begin((GLenum)cmd[0]);
+        cmd += 1;
+        break;
+      case CJS_GL_END:
+        gl::end();
+        break;
+      case CJS_GL_VERTEX:
+        CJS_OPERANDS(3);
+        gl::vertex(vec3(cmd[0], cmd[1], cmd[2]));
+        cmd += 3;
+        break;
+      default:
+        error = 2;
+        break;
+    }
+  }
+
+  #undef CJS_OPERANDS
+
+  if(error && errorAt){
+    *errorAt = (cmd - begin) - 1;
+  }
+
+  return error;
+}
+
+/**
+ * flush( float32Array, count );
+ * Decodes and executes a frame worth of commands written by lib/gl.js CommandBuffer,
+ * so a whole draw loop only needs one crossing into native land.
+ * While a record target is set (pipelined mode), the commands are copied for the render thread instead.
+ */
+void GLModule::flush(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  if(!args[0]->IsFloat32Array()){
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "Need a Float32Array command buffer")));
+    return;
+  }
+
+  Local<Float32Array> arr = args[0].As<Float32Array>();
+  size_t count = args[1]->Uint32Value();
+
+  if(count > arr->Length()){
+    count = arr->Length();
+  }
+
+  // The backing store stays owned by v8, we only read from it during this call
+  ArrayBuffer::Contents contents = arr->Buffer()->GetContents();
+  const float* cmd = reinterpret_cast<const float*>( static_cast<char*>(contents.Data()) + arr->ByteOffset() );
+
+  if(sRecordTarget){
+    sRecordTarget->insert(sRecordTarget->end(), cmd, cmd + count);
+    return;
+  }
+
+  size_t errorAt = 0;
+  int error = execute(cmd, count, &errorAt);
+
+  if(error){
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    std::string err = error == 1 ? "Truncated command at float " : "Unknown command at float ";
+    err.append(std::to_string(errorAt));
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, err.c_str())));
+  }
+
+  return;
+}
 
 
 // TODO
@@ -716,6 +975,9 @@ void GLModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "pushBoolState"), v8::FunctionTemplate::New(getIsolate(), pushBoolState));
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "popBoolState"), v8::FunctionTemplate::New(getIsolate(), popBoolState));
   
+  // Command buffer
+  glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "flush"), v8::FunctionTemplate::New(getIsolate(), flush));
+  
   // Primitives
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "drawCube"), v8::FunctionTemplate::New(getIsolate(), drawCube));
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "drawColorCube"), v8::FunctionTemplate::New(getIsolate(), drawColorCube));
@@ -749,6 +1011,7 @@ void GLModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "STREAM_COPY"), v8::Uint32::New(getIsolate(), GL_STREAM_COPY));
   
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ARRAY_BUFFER"), v8::Uint32::New(getIsolate(), GL_ARRAY_BUFFER));
+  glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "UNIFORM_BUFFER"), v8::Uint32::New(getIsolate(), GL_UNIFORM_BUFFER));
   
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "FLOAT"), v8::Uint32::New(getIsolate(), GL_FLOAT));
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "FALSE"), v8::Uint32::New(getIsolate(), GL_FALSE));
@@ -759,6 +1022,33 @@ void GLModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   
   glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "TRANSFORM_FEEDBACK_BUFFER"), v8::Uint32::New(getIsolate(), GL_TRANSFORM_FEEDBACK_BUFFER));
   
+  // Command buffer opcodes (see GLCommand in gl.hpp)
+  Handle<ObjectTemplate> cmdTemplate = ObjectTemplate::New(getIsolate());
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "END_OF_BUFFER"), v8::Uint32::New(getIsolate(), CJS_GL_END_OF_BUFFER));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "PUSH_MATRICES"), v8::Uint32::New(getIsolate(), CJS_GL_PUSH_MATRICES));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "POP_MATRICES"), v8::Uint32::New(getIsolate(), CJS_GL_POP_MATRICES));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "TRANSLATE"), v8::Uint32::New(getIsolate(), CJS_GL_TRANSLATE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "SCALE"), v8::Uint32::New(getIsolate(), CJS_GL_SCALE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ROTATE"), v8::Uint32::New(getIsolate(), CJS_GL_ROTATE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ROTATE_QUAT"), v8::Uint32::New(getIsolate(), CJS_GL_ROTATE_QUAT));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "COLOR"), v8::Uint32::New(getIsolate(), CJS_GL_COLOR));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ENABLE"), v8::Uint32::New(getIsolate(), CJS_GL_ENABLE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DISABLE"), v8::Uint32::New(getIsolate(), CJS_GL_DISABLE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ENABLE_DEPTH_READ"), v8::Uint32::New(getIsolate(), CJS_GL_ENABLE_DEPTH_READ));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DISABLE_DEPTH_READ"), v8::Uint32::New(getIsolate(), CJS_GL_DISABLE_DEPTH_READ));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "ENABLE_DEPTH_WRITE"), v8::Uint32::New(getIsolate(), CJS_GL_ENABLE_DEPTH_WRITE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DISABLE_DEPTH_WRITE"), v8::Uint32::New(getIsolate(), CJS_GL_DISABLE_DEPTH_WRITE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "CLEAR"), v8::Uint32::New(getIsolate(), CJS_GL_CLEAR));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DRAW_CUBE"), v8::Uint32::New(getIsolate(), CJS_GL_DRAW_CUBE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DRAW_COLOR_CUBE"), v8::Uint32::New(getIsolate(), CJS_GL_DRAW_COLOR_CUBE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DRAW_SPHERE"), v8::Uint32::New(getIsolate(), CJS_GL_DRAW_SPHERE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DRAW_LINE"), v8::Uint32::New(getIsolate(), CJS_GL_DRAW_LINE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "DRAW_SOLID_CIRCLE"), v8::Uint32::New(getIsolate(), CJS_GL_DRAW_SOLID_CIRCLE));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "BEGIN"), v8::Uint32::New(getIsolate(), CJS_GL_BEGIN));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "END"), v8::Uint32::New(getIsolate(), CJS_GL_END));
+  cmdTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "VERTEX"), v8::Uint32::New(getIsolate(), CJS_GL_VERTEX));
+  glTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "COMMANDS"), cmdTemplate);
+  
   // Expose global gl object
   global->Set(v8::String::NewFromUtf8(getIsolate(), "gl"), glTemplate);
 }
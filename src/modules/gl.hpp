@@ -30,9 +30,39 @@
 #include "cinder/Rect.h"
 #include "../PipeModule.hpp"
 
+#include <atomic>
+
 using namespace cinder;
 
 namespace cjs {
+
+// Opcodes for the command buffer decoded in GLModule::flush.
+// Each opcode is followed by a fixed number of float operands (noted in brackets).
+enum GLCommand {
+  CJS_GL_END_OF_BUFFER = 0,
+  CJS_GL_PUSH_MATRICES = 1,       // []
+  CJS_GL_POP_MATRICES = 2,        // []
+  CJS_GL_TRANSLATE = 3,           // [x, y, z]
+  CJS_GL_SCALE = 4,               // [x, y, z]
+  CJS_GL_ROTATE = 5,              // [angle]
+  CJS_GL_ROTATE_QUAT = 6,         // [w, x, y, z]
+  CJS_GL_COLOR = 7,               // [r, g, b, a]
+  CJS_GL_ENABLE = 8,              // [cap]
+  CJS_GL_DISABLE = 9,             // [cap]
+  CJS_GL_ENABLE_DEPTH_READ = 10,  // []
+  CJS_GL_DISABLE_DEPTH_READ = 11, // []
+  CJS_GL_ENABLE_DEPTH_WRITE = 12, // []
+  CJS_GL_DISABLE_DEPTH_WRITE = 13,// []
+  CJS_GL_CLEAR = 14,              // [r, g, b, a]
+  CJS_GL_DRAW_CUBE = 20,          // [cx, cy, cz, sx, sy, sz]
+  CJS_GL_DRAW_COLOR_CUBE = 21,    // [cx, cy, cz, sx, sy, sz]
+  CJS_GL_DRAW_SPHERE = 22,        // [cx, cy, cz, radius, segments]
+  CJS_GL_DRAW_LINE = 23,          // [sx, sy, sz, ex, ey, ez]
+  CJS_GL_DRAW_SOLID_CIRCLE = 24,  // [cx, cy, radius]
+  CJS_GL_BEGIN = 30,              // [mode]
+  CJS_GL_END = 31,                // []
+  CJS_GL_VERTEX = 32              // [x, y, z]
+};
   
 class GLModule : public PipeModule {
   
@@ -109,6 +139,31 @@ class GLModule : public PipeModule {
     static void pushBoolState(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void popBoolState(const v8::FunctionCallbackInfo<v8::Value>& args);
   
+    // Command buffer
+    static void flush(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
+    // Decode/replay commands, used by flush and the pipelined render thread
+    static int execute( const float* cmd, size_t count, size_t* errorAt );
+  
+    // While set, flush() appends to the target instead of executing (pipelined mode)
+    static void setRecordTarget( std::vector<float>* target ) {
+      sRecordTarget = target;
+    }
+  
+    // Drawing and matrix state that bypass the command buffer can not be replayed by the render thread,
+    // in pipelined mode they would hit the script thread's off-screen context and never reach the window.
+    // The first such entry point used is remembered, the app refuses or leaves pipelined mode once there is one.
+    static inline void checkUnrecorded( const char* what ) {
+      if(!sUnrecordedUse.load(std::memory_order_relaxed)){
+        sUnrecordedUse = what;
+      }
+    }
+  
+    // Name of the first entry point used outside the command buffer, null if there was none
+    static inline const char* getUnrecordedUse() {
+      return sUnrecordedUse;
+    }
+  
   private:
     //
     static ColorA sBufColorA_1;
@@ -118,6 +173,9 @@ class GLModule : public PipeModule {
     static vec3 bufVec3f_1;
     static vec3 bufVec3f_2;
     static quat bufQuat_1;
+  
+    static std::vector<float>* sRecordTarget;
+    static std::atomic<const char*> sUnrecordedUse;
 };
   
 } // namespace cjs
@@ -73,9 +73,7 @@ void GlmModule::destroyMat4(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
   
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    StaticFactory::remove<mat4>(isolate, id);
+    StaticFactory::remove<mat4>(isolate, args[0]);
   }
   
   return;
@@ -106,11 +104,8 @@ void GlmModule::multMat4(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
   
   if(!args[0].IsEmpty()){
-    uint32_t id1 = args[0]->ToUint32()->Value();
-    uint32_t id2 = args[1]->ToUint32()->Value();
-    
-    std::shared_ptr<mat4> matrix1 = StaticFactory::get<mat4>(id1);
-    std::shared_ptr<mat4> matrix2 = StaticFactory::get<mat4>(id2);
+    std::shared_ptr<mat4> matrix1 = StaticFactory::get<mat4>(args[0]);
+    std::shared_ptr<mat4> matrix2 = StaticFactory::get<mat4>(args[1]);
     
     matrix1->operator*=(*matrix2);
   }
@@ -148,9 +143,7 @@ void GlmModule::destroyVec3(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
   
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    StaticFactory::remove<vec3>(isolate, id);
+    StaticFactory::remove<vec3>(isolate, args[0]);
   }
   
   return;
@@ -160,13 +153,10 @@ void GlmModule::addVec3(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
   
-  uint32_t id1 = args[0]->ToUint32()->Value();
-  std::shared_ptr<vec3> vector1 = StaticFactory::get<vec3>(id1);
+  std::shared_ptr<vec3> vector1 = StaticFactory::get<vec3>(args[0]);
   
   if(args.Length() == 2){
-    uint32_t id2 = args[1]->ToUint32()->Value();
-    
-    std::shared_ptr<vec3> vector2 = StaticFactory::get<vec3>(id2);
+    std::shared_ptr<vec3> vector2 = StaticFactory::get<vec3>(args[1]);
     
     vector1->operator+=(*vector2);
   }
@@ -192,8 +182,7 @@ void GlmModule::setVec3(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
   
-  uint32_t id1 = args[0]->ToUint32()->Value();
-  std::shared_ptr<vec3> vector1 = StaticFactory::get<vec3>(id1);
+  std::shared_ptr<vec3> vector1 = StaticFactory::get<vec3>(args[0]);
   
   vector1->x = args[1]->NumberValue();
   vector1->y = args[2]->NumberValue();
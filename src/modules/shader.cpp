@@ -23,7 +23,15 @@
 #include "shader.hpp"
 #include "AppConsole.h"
 #include "../StaticFactory.hpp"
+#include "../FileWatcher.hpp"
+#include "../CodeCache.hpp"
 #include "cinder/gl/Shader.h"
+#include "cinder/gl/scoped.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
 
 using namespace std;
 using namespace cinder;
@@ -32,6 +40,375 @@ using namespace v8;
 
 namespace cjs {
 
+const double ShaderModule::kSlowCompileSeconds = 0.1;
+ShaderModule::CompileStats ShaderModule::sCompileStats;
+
+void ShaderModule::recordCompile( const std::string &name, double seconds, bool cached ) {
+  sCompileStats.programs++;
+  sCompileStats.seconds += seconds;
+  if(cached){
+    sCompileStats.cached++;
+  }
+  if(seconds > sCompileStats.slowest){
+    sCompileStats.slowest = seconds;
+    sCompileStats.slowestName = name;
+  }
+  
+  if(seconds > kSlowCompileSeconds){
+    AppConsole::log("Shader " + name + " took " + std::to_string((int)(seconds * 1000)) + "ms to compile and link", LOG_WARN);
+  }
+}
+
+//
+// Program binary cache
+
+static const uint32_t kProgramCacheMagic = 0x434a5350; // CJSP
+
+struct ProgramFileHeader {
+  uint32_t magic;
+  uint32_t driverHash;
+  uint32_t sourceHash;
+  uint32_t binaryFormat;
+  uint32_t length;
+};
+
+// A GlslProg that takes its program from a binary instead of its stages.
+// It is built from a trivial stub format, the binary then replaces the stub's program behind
+// the same handle and the active attributes, uniforms and blocks are read back from it.
+// Relies on GlslProg's protected constructor and caches.
+class BinaryGlslProg : public GlslProg {
+  public:
+  BinaryGlslProg( const GlslProg::Format &stub ) : GlslProg(stub) {}
+  
+  bool loadBinary( GLenum binaryFormat, const std::vector<uint8_t> &data ) {
+    glProgramBinary(mHandle, binaryFormat, data.data(), (GLsizei)data.size());
+    
+    GLint status = GL_FALSE;
+    glGetProgramiv(mHandle, GL_LINK_STATUS, &status);
+    if(status != GL_TRUE){
+      return false;
+    }
+    
+    // Attributes keep the semantics and locations given by the format
+    mUniforms.clear();
+    mUniformBlocks.clear();
+    mTransformFeedbackVaryings.clear();
+    cacheActiveAttribs();
+    cacheActiveUniforms();
+    cacheActiveUniformBlocks();
+    cacheActiveTransformFeedbackVaryings();
+    return true;
+  }
+};
+
+static uint32_t hashString( const std::string &str, uint32_t seed ) {
+  // Length first, so stage boundaries can not shift between sources
+  uint32_t length = (uint32_t)str.size();
+  seed = CodeCache::hash((const char*)&length, sizeof(length), seed);
+  return CodeCache::hash(str.data(), str.size(), seed);
+}
+
+// Everything linked into the program, 0 if the format can not be cached
+static uint32_t hashFormat( const GlslProg::Format &format ) {
+  const std::string* stages[3] = { &format.getVertex(), &format.getFragment(), &format.getGeometry() };
+  
+  uint32_t h = 2166136261u;
+  for(const std::string* stage : stages){
+    // Included files are not part of the sources hashed here
+    if(stage->find("#include") != std::string::npos){
+      return 0;
+    }
+    h = hashString(*stage, h);
+  }
+  for(const std::string& varying : format.getVaryings()){
+    h = hashString(varying, h);
+  }
+  GLenum feedbackFormat = format.getTransformFormat();
+  h = CodeCache::hash((const char*)&feedbackFormat, sizeof(feedbackFormat), h);
+  for(const GlslProg::Attribute& attrib : format.getAttributes()){
+    h = hashString(attrib.mName, h);
+    h = CodeCache::hash((const char*)&attrib.mLoc, sizeof(attrib.mLoc), h);
+  }
+  return h ? h : 1;
+}
+
+// A binary only loads on the driver that produced it
+static uint32_t hashDriver() {
+  uint32_t h = 2166136261u;
+  const GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  for(GLenum name : names){
+    const char* str = (const char*)glGetString(name);
+    h = hashString(str ? str : "", h);
+  }
+  return h;
+}
+
+static bool readProgram( const fs::path &file, uint32_t driverHash, uint32_t sourceHash, GLenum *binaryFormat, std::vector<uint8_t> *data ) {
+  std::ifstream in(file.string(), std::ios::binary);
+  if(!in) return false;
+  
+  ProgramFileHeader header;
+  if(!in.read((char*)&header, sizeof(header))) return false;
+  if(header.magic != kProgramCacheMagic || header.driverHash != driverHash
+    || header.sourceHash != sourceHash || header.length == 0){
+    return false;
+  }
+  
+  *binaryFormat = header.binaryFormat;
+  data->resize(header.length);
+  return (bool)in.read((char*)data->data(), header.length);
+}
+
+static void writeProgram( const fs::path &file, uint32_t driverHash, uint32_t sourceHash, GLuint program ) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if(length <= 0){
+    return;
+  }
+  
+  std::vector<uint8_t> data(length);
+  GLenum binaryFormat = 0;
+  GLsizei written = 0;
+  glGetProgramBinary(program, length, &written, &binaryFormat, data.data());
+  if(written <= 0){
+    return;
+  }
+  
+  // Written from the script thread and the GL worker, each to its own temporary file
+  fs::path tmp = file;
+  tmp += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream out(tmp.string(), std::ios::binary | std::ios::trunc);
+    if(!out) return;
+    ProgramFileHeader header = { kProgramCacheMagic, driverHash, sourceHash, binaryFormat, (uint32_t)written };
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)data.data(), written);
+    if(!out) return;
+  }
+  boost::system::error_code ec;
+  fs::rename(tmp, file, ec);
+}
+
+gl::GlslProgRef ShaderModule::createProgram( const GlslProg::Format &format, bool *cached ) {
+  *cached = false;
+  
+  GLint binaryFormats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+  uint32_t sourceHash = hashFormat(format);
+  fs::path dir = CodeCache::getDirectory();
+  
+  if(binaryFormats <= 0 || !sourceHash || dir.empty()){
+    return GlslProg::create( format );
+  }
+  
+  dir /= "programs";
+  boost::system::error_code ec;
+  fs::create_directories(dir, ec);
+  
+  uint32_t driverHash = hashDriver();
+  char key[9];
+  snprintf(key, sizeof(key), "%08x", sourceHash);
+  fs::path file = dir / (std::string(key) + ".glbin");
+  
+  GLenum binaryFormat = 0;
+  std::vector<uint8_t> data;
+  if(readProgram(file, driverHash, sourceHash, &binaryFormat, &data)){
+    GlslProg::Format stub = format;
+    stub.vertex(std::string("#version 150\nvoid main() { gl_Position = vec4(0.0); }\n"));
+    stub.fragment(std::string("#version 150\nout vec4 oColor;\nvoid main() { oColor = vec4(0.0); }\n"));
+    stub.geometry(std::string());
+    stub.feedbackVaryings(std::vector<std::string>());
+    
+    try {
+      std::shared_ptr<BinaryGlslProg> glsl(new BinaryGlslProg(stub));
+      if(glsl->loadBinary(binaryFormat, data)){
+        *cached = true;
+        return glsl;
+      }
+    } catch(cinder::Exception &ex){
+      // The stub did not build, compiled below
+    }
+    // Rejected by the driver (updated in place), compiled and rewritten below
+  }
+  
+  gl::GlslProgRef glsl = GlslProg::create( format );
+  writeProgram(file, driverHash, sourceHash, glsl->getHandle());
+  return glsl;
+}
+
+//
+// Hot reload
+
+struct ShaderModule::ReloadEntry {
+  uint32_t id;
+  std::string name;
+  GlslProg::Format format;      // stage sources are re-read into a copy of it
+  StageFiles files;
+  std::vector<uint32_t> watches;
+  std::map<std::string, uint32_t> blockBindings; // from uniformBlock(), applied to reloaded programs
+  NextFrameFn changed;          // repeat, hands file changes to the script thread
+  std::atomic<bool> queued;     // a change is waiting for the script thread
+  bool compiling = false;
+  bool dirty = false;           // changed again while compiling
+};
+
+bool ShaderModule::sHotReload = true;
+std::map<uint32_t, std::shared_ptr<ShaderModule::ReloadEntry>> ShaderModule::sReloadEntries;
+std::map<uint32_t, ShaderModule::StageFiles> ShaderModule::sFormatFiles;
+v8::Persistent<v8::Function> ShaderModule::sReloadCallback;
+
+void ShaderModule::watchProgram( uint32_t id, const std::string &name, const GlslProg::Format &format, const StageFiles &files ) {
+  if(!sHotReload){
+    return;
+  }
+  
+  std::shared_ptr<ReloadEntry> entry(new ReloadEntry());
+  entry->id = id;
+  entry->name = name;
+  entry->format = format;
+  entry->files = files;
+  entry->queued = false;
+  
+  std::weak_ptr<ReloadEntry> weakEntry = entry;
+  entry->changed.reset(new NextFrameFnHolder());
+  entry->changed->repeat = true;
+  entry->changed->complete = [weakEntry](Isolate* isolate, Local<Function> fn){
+    std::shared_ptr<ReloadEntry> entry = weakEntry.lock();
+    if(entry){
+      entry->queued = false;
+      reloadProgram(entry);
+    }
+  };
+  
+  // Watcher thread, changes within a frame are picked up once
+  auto onChange = [entry](const std::string& event, const std::string& filename){
+    if(!entry->queued.exchange(true)){
+      PipeModule::nextFrame(entry->changed);
+    }
+  };
+  
+  for(const fs::path& file : files){
+    if(file.empty()) continue;
+    
+    std::string error;
+    uint32_t watchId = FileWatcher::add(file, onChange, &error);
+    if(watchId){
+      entry->watches.push_back(watchId);
+    } else {
+      AppConsole::log("Shader " + name + " can not be reloaded, " + error, LOG_WARN);
+    }
+  }
+  
+  if(entry->watches.empty()){
+    return;
+  }
+  
+  // The worker context is shared from the current one, create it while that is the script thread's
+  PipeModule::getGLWorker();
+  
+  unwatchProgram(id);
+  sReloadEntries[id] = entry;
+  
+  // A shader collected from js without destroy() stops watching as well
+  StaticFactory::onRemove<GlslProg>(id, [id](){
+    unwatchProgram(id);
+  });
+}
+
+void ShaderModule::unwatchProgram( uint32_t id ) {
+  auto it = sReloadEntries.find(id);
+  if(it == sReloadEntries.end()){
+    return;
+  }
+  
+  for(uint32_t watchId : it->second->watches){
+    FileWatcher::remove(watchId);
+  }
+  sReloadEntries.erase(it);
+}
+
+void ShaderModule::reloadProgram( std::shared_ptr<ReloadEntry> entry ) {
+  if(entry->compiling){
+    entry->dirty = true;
+    return;
+  }
+  entry->compiling = true;
+  
+  GlslProg::Format format = entry->format;
+  StageFiles files = entry->files;
+  
+  PipeModule::getGLWorker().submit([entry, format, files]() mutable {
+    gl::GlslProgRef glsl;
+    std::string error;
+    bool cached = false;
+    auto start = std::chrono::steady_clock::now();
+    
+    try {
+      if(!files[0].empty()) format.vertex( loadFile(files[0]) );
+      if(!files[1].empty()) format.fragment( loadFile(files[1]) );
+      if(!files[2].empty()) format.geometry( loadFile(files[2]) );
+      glsl = createProgram( format, &cached );
+    } catch(cinder::gl::GlslProgCompileExc &ex){
+      error = ex.what();
+    } catch(cinder::Exception &ex){
+      error = ex.what();
+    }
+    
+    glFlush();
+    double seconds = secondsSince(start);
+    
+    NextFrameFn nffn(new NextFrameFnHolder());
+    nffn->complete = [entry, glsl, error, seconds, cached](Isolate* isolate, Local<Function> fn){
+      finishReload(isolate, entry, glsl, error, seconds, cached);
+    };
+    PipeModule::nextFrame(nffn);
+  });
+}
+
+void ShaderModule::finishReload( v8::Isolate* isolate, std::shared_ptr<ReloadEntry> entry, gl::GlslProgRef glsl, const std::string &error, double seconds, bool cached ) {
+  entry->compiling = false;
+  
+  // Unwatched (destroyed) while compiling
+  auto it = sReloadEntries.find(entry->id);
+  if(it == sReloadEntries.end() || it->second != entry){
+    return;
+  }
+  
+  if(glsl){
+    // Uniform values are per program and start out empty, block bindings are carried over
+    for(auto& binding : entry->blockBindings){
+      if(glsl->getUniformBlockLocation(binding.first) >= 0){
+        glsl->uniformBlock(binding.first, binding.second);
+      }
+    }
+    
+    // The program was collected from js without destroy()
+    if(!StaticFactory::replace<GlslProg>(entry->id, glsl)){
+      unwatchProgram(entry->id);
+      return;
+    }
+    recordCompile(entry->name, seconds, cached);
+    AppConsole::log("Shader " + entry->name + " reloaded");
+  } else {
+    AppConsole::log("Shader " + entry->name + " failed to reload, keeping the previous program\n" + error, LOG_ERROR);
+  }
+  
+  if(!sReloadCallback.IsEmpty()){
+    v8::HandleScope scope(isolate);
+    Local<Function> callback = Local<Function>::New(isolate, sReloadCallback);
+    Local<Value> argv[2] = {
+      v8::Uint32::New(isolate, entry->id),
+      glsl ? Local<Value>(v8::Null(isolate)) : Local<Value>(v8::Exception::SyntaxError(v8::String::NewFromUtf8(isolate, error.c_str())))
+    };
+    callback->Call(callback->CreationContext()->Global(), 2, argv);
+  }
+  
+  if(entry->dirty){
+    entry->dirty = false;
+    reloadProgram(entry);
+  }
+}
+
 void ShaderModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
@@ -47,28 +424,20 @@ void ShaderModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::String::Utf8Value utf8Geom(lGeom);
     
     gl::GlslProgRef glsl;
+    bool cached = false;
+    auto start = std::chrono::steady_clock::now();
     
     try {
       // TODO: Take prog strings optionally (-> shader.js)
-      //glsl = gl::GlslProg::create( *utf8Vert, *utf8Frag );
-      if( args.Length() == 2 ){
-        glsl = gl::GlslProg::create(
-          getApp()->loadAsset(fs::path(*utf8Vert))
-        );
-      }
-      else if( args.Length() == 3 ){
-        glsl = gl::GlslProg::create(
-          getApp()->loadAsset(fs::path(*utf8Vert)),
-          getApp()->loadAsset(fs::path(*utf8Frag))
-        );
+      GlslProg::Format format;
+      format.vertex( getApp()->loadAsset(fs::path(*utf8Vert)) );
+      if( args.Length() > 2 ){
+        format.fragment( getApp()->loadAsset(fs::path(*utf8Frag)) );
       }
-      else if( args.Length() == 4 ){
-        glsl = gl::GlslProg::create(
-          getApp()->loadAsset(fs::path(*utf8Vert)),
-          getApp()->loadAsset(fs::path(*utf8Frag)),
-          getApp()->loadAsset(fs::path(*utf8Geom))
-        );
+      if( args.Length() > 3 ){
+        format.geometry( getApp()->loadAsset(fs::path(*utf8Geom)) );
       }
+      glsl = createProgram( format, &cached );
     } catch(cinder::gl::GlslProgCompileExc &ex){
       isolate->ThrowException(v8::Exception::SyntaxError(
         v8::String::NewFromUtf8(isolate, ex.what())
@@ -81,7 +450,18 @@ void ShaderModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
       return;
     }
     
-    StaticFactory::put<GlslProg>( isolate, glsl, args[0]->ToObject() );
+    recordCompile(*utf8Vert, secondsSince(start), cached);
+    
+    Local<Object> handle = args[0]->ToObject();
+    StaticFactory::put<GlslProg>( isolate, glsl, handle );
+    
+    if(sHotReload){
+      StageFiles files;
+      files[0] = getApp()->getAssetPath(fs::path(*utf8Vert));
+      if( args.Length() > 2 ) files[1] = getApp()->getAssetPath(fs::path(*utf8Frag));
+      if( args.Length() > 3 ) files[2] = getApp()->getAssetPath(fs::path(*utf8Geom));
+      watchProgram(handle->Get(v8::String::NewFromUtf8(isolate, "id"))->Uint32Value(), *utf8Vert, GlslProg::Format(), files);
+    }
   }
   
   return;
@@ -102,15 +482,112 @@ void ShaderModule::createFromFormat(const v8::FunctionCallbackInfo<v8::Value>& a
       return;
     }
     
-    gl::GlslProgRef glsl = gl::GlslProg::create( *format );
+    gl::GlslProgRef glsl;
+    bool cached = false;
+    auto start = std::chrono::steady_clock::now();
+    
+    try {
+      glsl = createProgram( *format, &cached );
+    } catch(cinder::gl::GlslProgCompileExc &ex){
+      isolate->ThrowException(v8::Exception::SyntaxError(
+        v8::String::NewFromUtf8(isolate, ex.what())
+      ));
+      return;
+    } catch(cinder::Exception &ex){
+      isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, ex.what())
+      ));
+      return;
+    }
+    
+    recordCompile("format " + std::to_string(id), secondsSince(start), cached);
+    
+    Local<Object> handle = args[0]->ToObject();
+    StaticFactory::put<GlslProg>( isolate, glsl, handle );
     
-    StaticFactory::put<GlslProg>( isolate, glsl, args[0]->ToObject() );
+    auto files = sFormatFiles.find(id);
+    if(files != sFormatFiles.end()){
+      watchProgram(handle->Get(v8::String::NewFromUtf8(isolate, "id"))->Uint32Value(), "format " + std::to_string(id), *format, files->second);
+    }
   }
   
   return;
 }
 
 
+/**
+ * createAsync( handle, formatId, callback )
+ * Compiles and links the format on the GL worker's shared context, so the calling frame does not block.
+ * Calls back with the next frame as callback(err), compile errors are passed as SyntaxError.
+ */
+void ShaderModule::createAsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  if(!args[0]->IsObject() || !args[2]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "createAsync needs a handle, a format and a callback")));
+    return;
+  }
+  
+  uint32_t id = args[1]->ToUint32()->Value();
+  std::shared_ptr<GlslProg::Format> format = StaticFactory::get<GlslProg::Format>(id);
+  
+  if(!format){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Format does not exist")));
+    return;
+  }
+  
+  // Copy, the format may be changed or destroyed from js while compiling
+  GlslProg::Format formatCopy = *format;
+  std::string name = "format " + std::to_string(id);
+  auto formatFiles = sFormatFiles.find(id);
+  StageFiles files = formatFiles != sFormatFiles.end() ? formatFiles->second : StageFiles();
+  
+  std::shared_ptr<v8::Persistent<v8::Object>> handle(new v8::Persistent<v8::Object>(isolate, args[0]->ToObject()));
+  NextFrameFn nffn(new NextFrameFnHolder());
+  nffn->v8Fn.Reset(isolate, args[2].As<Function>());
+  
+  PipeModule::getGLWorker().submit([formatCopy, name, files, handle, nffn](){
+    gl::GlslProgRef glsl;
+    std::string error;
+    bool syntaxError = false;
+    bool cached = false;
+    auto start = std::chrono::steady_clock::now();
+    
+    try {
+      glsl = createProgram( formatCopy, &cached );
+    } catch(cinder::gl::GlslProgCompileExc &ex){
+      error = ex.what();
+      syntaxError = true;
+    } catch(cinder::Exception &ex){
+      error = ex.what();
+    }
+    
+    // Programs are shared between contexts, make sure the link is visible to them
+    glFlush();
+    double seconds = secondsSince(start);
+    
+    // Runs on the script thread
+    nffn->complete = [handle, glsl, error, syntaxError, formatCopy, name, files, seconds, cached](Isolate* isolate, Local<Function> callback){
+      Local<Value> argv[1] = { v8::Null(isolate) };
+      if(glsl){
+        recordCompile(name, seconds, cached);
+        Local<Object> holder = Local<Object>::New(isolate, *handle);
+        StaticFactory::put<GlslProg>( isolate, glsl, holder );
+        if(!files[0].empty() || !files[1].empty() || !files[2].empty()){
+          watchProgram(holder->Get(v8::String::NewFromUtf8(isolate, "id"))->Uint32Value(), name, formatCopy, files);
+        }
+      } else {
+        Local<String> msg = v8::String::NewFromUtf8(isolate, error.c_str());
+        argv[0] = syntaxError ? v8::Exception::SyntaxError(msg) : v8::Exception::Error(msg);
+      }
+      handle->Reset();
+      callback->Call(callback->CreationContext()->Global(), 1, argv);
+    };
+    PipeModule::nextFrame(nffn);
+  });
+}
+
 void ShaderModule::destroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
@@ -118,6 +595,7 @@ void ShaderModule::destroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
   if(!args[0].IsEmpty()){
     uint32_t id = args[0]->ToUint32()->Value();
     
+    unwatchProgram(id);
     StaticFactory::remove<GlslProg>(isolate, id);
   }
   
@@ -159,12 +637,18 @@ void ShaderModule::uniformInt(const v8::FunctionCallbackInfo<v8::Value>& args) {
       return;
     }
     
+    int value = args[2]->ToUint32()->Value();
+    
+    // Integer locations come from getUniformLocation and skip the lookup by name
+    if(args[1]->IsInt32()){
+      shader->uniform(args[1]->Int32Value(), value);
+      return;
+    }
+    
     Local<String> locationStr = args[1]->ToString();
     v8::String::Utf8Value location(locationStr);
     const std::string loc(*location);
     
-    int value = args[2]->ToUint32()->Value();
-    
     shader->uniform(loc, value);
   }
   
@@ -185,12 +669,18 @@ void ShaderModule::uniformFloat(const v8::FunctionCallbackInfo<v8::Value>& args)
       return;
     }
     
+    float value = args[2]->ToNumber()->Value();
+    
+    // Integer locations come from getUniformLocation and skip the lookup by name
+    if(args[1]->IsInt32()){
+      shader->uniform(args[1]->Int32Value(), value);
+      return;
+    }
+    
     Local<String> locationStr = args[1]->ToString();
     v8::String::Utf8Value location(locationStr);
     const std::string loc(*location);
     
-    float value = args[2]->ToNumber()->Value();
-    
     shader->uniform(loc, value);
   }
   
@@ -211,10 +701,6 @@ void ShaderModule::uniformVec3(const v8::FunctionCallbackInfo<v8::Value>& args)
       return;
     }
     
-    Local<String> locationStr = args[1]->ToString();
-    v8::String::Utf8Value location(locationStr);
-    const std::string loc(*location);
-    
     uint32_t vectorId = args[2]->ToUint32()->Value();
     std::shared_ptr<vec3> vector = StaticFactory::get<vec3>(vectorId);
     
@@ -223,12 +709,179 @@ void ShaderModule::uniformVec3(const v8::FunctionCallbackInfo<v8::Value>& args)
       return;
     }
     
+    if(args[1]->IsInt32()){
+      shader->uniform(args[1]->Int32Value(), *vector);
+      return;
+    }
+    
+    Local<String> locationStr = args[1]->ToString();
+    v8::String::Utf8Value location(locationStr);
+    const std::string loc(*location);
+    
     shader->uniform(loc, *vector);
   }
   
   return;
 }
 
+/**
+ * getUniformLocation( id, name ) -> location
+ * -1 if the program has no active uniform with that name.
+ */
+void ShaderModule::getUniformLocation(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  GlslProgRef shader = StaticFactory::get<GlslProg>(args[0]->Uint32Value());
+  
+  if(!shader){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Shader does not exist")));
+    return;
+  }
+  
+  v8::String::Utf8Value name(args[1]);
+  args.GetReturnValue().Set(v8::Int32::New(isolate, shader->getUniformLocation(*name)));
+}
+
+/**
+ * uniforms( id, data, layout )
+ * Uploads many float uniforms in one call. data is a Float32Array read front to back,
+ * layout an Int32Array of (location, components, count) triples, components is
+ * 1 to 4 for float to vec4, 9 for mat3 and 16 for mat4.
+ */
+void ShaderModule::uniforms(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  GlslProgRef shader = StaticFactory::get<GlslProg>(args[0]->Uint32Value());
+  
+  if(!shader){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Shader does not exist")));
+    return;
+  }
+  
+  if(!args[1]->IsFloat32Array() || !args[2]->IsInt32Array()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "Need a Float32Array of values and an Int32Array layout")));
+    return;
+  }
+  
+  Local<Float32Array> data = args[1].As<Float32Array>();
+  Local<Int32Array> layout = args[2].As<Int32Array>();
+  
+  const float* values = reinterpret_cast<const float*>(static_cast<char*>(data->Buffer()->GetContents().Data()) + data->ByteOffset());
+  const int32_t* entries = reinterpret_cast<const int32_t*>(static_cast<char*>(layout->Buffer()->GetContents().Data()) + layout->ByteOffset());
+  size_t numValues = data->Length();
+  size_t numEntries = layout->Length() / 3;
+  
+  gl::ScopedGlslProg scopedShader(shader);
+  
+  size_t offset = 0;
+  for(size_t i = 0; i < numEntries; i++){
+    GLint location = entries[i * 3];
+    GLint components = entries[i * 3 + 1];
+    GLsizei count = std::max(entries[i * 3 + 2], 1);
+    size_t size = (size_t)components * count;
+    
+    if(offset + size > numValues){
+      isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Uniform layout exceeds the data")));
+      return;
+    }
+    
+    const float* value = values + offset;
+    switch(components){
+      case 1: glUniform1fv(location, count, value); break;
+      case 2: glUniform2fv(location, count, value); break;
+      case 3: glUniform3fv(location, count, value); break;
+      case 4: glUniform4fv(location, count, value); break;
+      case 9: glUniformMatrix3fv(location, count, GL_FALSE, value); break;
+      case 16: glUniformMatrix4fv(location, count, GL_FALSE, value); break;
+      default:
+        isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "Uniform components must be 1, 2, 3, 4, 9 or 16")));
+        return;
+    }
+    offset += size;
+  }
+}
+
+/**
+ * uniformBlock( id, name, binding )
+ * Assigns the named uniform block to a binding point, a Vbo bound there with bindBase
+ * feeds every program that uses the same binding.
+ */
+void ShaderModule::uniformBlock(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  uint32_t id = args[0]->Uint32Value();
+  GlslProgRef shader = StaticFactory::get<GlslProg>(id);
+  
+  if(!shader){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Shader does not exist")));
+    return;
+  }
+  
+  v8::String::Utf8Value name(args[1]);
+  
+  if(shader->getUniformBlockLocation(*name) < 0){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Uniform block does not exist")));
+    return;
+  }
+  
+  uint32_t binding = args[2]->Uint32Value();
+  shader->uniformBlock(*name, binding);
+  
+  auto entry = sReloadEntries.find(id);
+  if(entry != sReloadEntries.end()){
+    entry->second->blockBindings[*name] = binding;
+  }
+}
+
+
+/**
+ * getCompileStats() -> {programs, seconds, slowest, slowestName, cached}
+ */
+void ShaderModule::getCompileStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  Local<Object> result = Object::New(isolate);
+  result->Set(v8::String::NewFromUtf8(isolate, "programs"), v8::Uint32::New(isolate, sCompileStats.programs));
+  result->Set(v8::String::NewFromUtf8(isolate, "seconds"), v8::Number::New(isolate, sCompileStats.seconds));
+  result->Set(v8::String::NewFromUtf8(isolate, "slowest"), v8::Number::New(isolate, sCompileStats.slowest));
+  result->Set(v8::String::NewFromUtf8(isolate, "slowestName"), v8::String::NewFromUtf8(isolate, sCompileStats.slowestName.c_str()));
+  result->Set(v8::String::NewFromUtf8(isolate, "cached"), v8::Uint32::New(isolate, sCompileStats.cached));
+  
+  args.GetReturnValue().Set(result);
+}
+
+/**
+ * setHotReload( enabled )
+ * Programs created while enabled (default) are recompiled when their shader files change.
+ */
+void ShaderModule::setHotReload(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  sHotReload = args[0]->BooleanValue();
+  
+  if(!sHotReload){
+    while(!sReloadEntries.empty()){
+      unwatchProgram(sReloadEntries.begin()->first);
+    }
+  }
+}
+
+/**
+ * setReloadCallback( callback )
+ * callback(id, err) after a program was recompiled, err is set if it kept the previous program.
+ */
+void ShaderModule::setReloadCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  if(args[0]->IsFunction()){
+    sReloadCallback.Reset(isolate, args[0].As<Function>());
+  } else {
+    sReloadCallback.Reset();
+  }
+}
 
 //
 // Format
@@ -251,6 +904,7 @@ void ShaderModule::destroyFormat(const v8::FunctionCallbackInfo<v8::Value>& args
   if(!args[0].IsEmpty()){
     uint32_t id = args[0]->ToUint32()->Value();
     
+    sFormatFiles.erase(id);
     StaticFactory::remove<GlslProg::Format>(isolate, id);
   }
   
@@ -276,6 +930,7 @@ void ShaderModule::formatVertex(const v8::FunctionCallbackInfo<v8::Value>& args)
     
     // TODO: catch glsl prog exceptions
     format->vertex( getApp()->loadAsset(*utf8Shader) );
+    sFormatFiles[id][0] = getApp()->getAssetPath(*utf8Shader);
   }
   
   return;
@@ -300,6 +955,7 @@ void ShaderModule::formatFragment(const v8::FunctionCallbackInfo<v8::Value>& arg
     
     // TODO: catch glsl prog exceptions
     format->fragment( getApp()->loadAsset(*utf8Shader) );
+    sFormatFiles[id][1] = getApp()->getAssetPath(*utf8Shader);
   }
   
   return;
@@ -324,6 +980,7 @@ void ShaderModule::formatGeometry(const v8::FunctionCallbackInfo<v8::Value>& arg
     
     // TODO: catch glsl prog exceptions
     format->geometry( getApp()->loadAsset(*utf8Shader) );
+    sFormatFiles[id][2] = getApp()->getAssetPath(*utf8Shader);
   }
   
   return;
@@ -430,12 +1087,19 @@ void ShaderModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "create"), v8::FunctionTemplate::New(getIsolate(), create));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createFromFormat"), v8::FunctionTemplate::New(getIsolate(), createFromFormat));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createAsync"), v8::FunctionTemplate::New(getIsolate(), createAsync));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroy"), v8::FunctionTemplate::New(getIsolate(), destroy));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "bind"), v8::FunctionTemplate::New(getIsolate(), bind));
   
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "uniformInt"), v8::FunctionTemplate::New(getIsolate(), uniformInt));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "uniformFloat"), v8::FunctionTemplate::New(getIsolate(), uniformFloat));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "uniformVec3"), v8::FunctionTemplate::New(getIsolate(), uniformVec3));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "getUniformLocation"), v8::FunctionTemplate::New(getIsolate(), getUniformLocation));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "uniforms"), v8::FunctionTemplate::New(getIsolate(), uniforms));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "uniformBlock"), v8::FunctionTemplate::New(getIsolate(), uniformBlock));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "getCompileStats"), v8::FunctionTemplate::New(getIsolate(), getCompileStats));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "setHotReload"), v8::FunctionTemplate::New(getIsolate(), setHotReload));
+  shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "setReloadCallback"), v8::FunctionTemplate::New(getIsolate(), setReloadCallback));
   
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "createFormat"), v8::FunctionTemplate::New(getIsolate(), createFormat));
   shaderTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroyFormat"), v8::FunctionTemplate::New(getIsolate(), destroyFormat));
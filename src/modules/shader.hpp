@@ -27,8 +27,11 @@
 #define SHADER_MOD_ID 9
 
 #include <map>
+#include <array>
+#include <chrono>
 
 #include "../PipeModule.hpp"
+#include "cinder/gl/GlslProg.h"
 
 namespace cjs {
   
@@ -47,12 +50,16 @@ class ShaderModule : public PipeModule {
   
     static void create(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void createFromFormat(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void createAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     static void uniformInt(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void uniformFloat(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void uniformVec3(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getUniformLocation(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void uniforms(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void uniformBlock(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     static void createFormat(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void destroyFormat(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -63,11 +70,53 @@ class ShaderModule : public PipeModule {
     static void formatFeedbackVaryings(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void formatAttribLocation(const v8::FunctionCallbackInfo<v8::Value>& args);
   
+    static void getCompileStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void setHotReload(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void setReloadCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
     static void getStockColor(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void getStockTexture(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     void loadGlobalJS( v8::Local<v8::ObjectTemplate> &global );
-    
+  
+  private:
+    // Compile and link time of created programs, slow ones are logged
+    struct CompileStats {
+      uint32_t programs = 0;
+      double seconds = 0;
+      double slowest = 0;
+      std::string slowestName;
+      uint32_t cached = 0;  // loaded from the program binary cache
+    };
+    static const double kSlowCompileSeconds;
+    static CompileStats sCompileStats;
+  
+    static void recordCompile( const std::string &name, double seconds, bool cached );
+  
+    // Program binary cache, linked programs are stored below the code cache directory with
+    // glGetProgramBinary and loaded with glProgramBinary on later launches, keyed by their
+    // sources and the driver. Falls back to compiling where the driver has no binary formats.
+    // Safe to call on the GL worker, throws like GlslProg::create.
+    static cinder::gl::GlslProgRef createProgram( const cinder::gl::GlslProg::Format &format, bool *cached );
+  
+    // Hot reload, programs built from shader files are recompiled on the GL worker when a
+    // stage file changes and swapped in behind their id once they link, a failed compile keeps
+    // the running program. Entries live on the script thread only.
+    struct ReloadEntry;
+    typedef std::array<cinder::fs::path, 3> StageFiles; // vertex, fragment, geometry, empty if unused
+    static bool sHotReload;
+    static std::map<uint32_t, std::shared_ptr<ReloadEntry>> sReloadEntries;
+    static std::map<uint32_t, StageFiles> sFormatFiles;
+    static v8::Persistent<v8::Function> sReloadCallback;
+  
+    static void watchProgram( uint32_t id, const std::string &name, const cinder::gl::GlslProg::Format &format, const StageFiles &files );
+    static void unwatchProgram( uint32_t id );
+    static void reloadProgram( std::shared_ptr<ReloadEntry> entry );
+    static void finishReload( v8::Isolate* isolate, std::shared_ptr<ReloadEntry> entry, cinder::gl::GlslProgRef glsl, const std::string &error, double seconds, bool cached );
+  
+    static inline double secondsSince( std::chrono::steady_clock::time_point start ) {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
  };
   
 } // namespace cjs
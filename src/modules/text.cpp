@@ -22,6 +22,7 @@
 
 #include "text.hpp"
 #include "AppConsole.h"
+#include "gl.hpp"
 
 using namespace std;
 using namespace cinder;
@@ -54,6 +55,7 @@ void TextModule::drawSimpleText(const v8::FunctionCallbackInfo<v8::Value>& args)
   uint32_t id = args[0]->Uint32Value();
   std::shared_ptr<SimpleText> textObj = sTextObjects[id];
   if( textObj ){
+    GLModule::checkUnrecorded("SimpleText.draw");
     textObj->draw();
   }
 }
@@ -24,7 +24,9 @@
 #include "AppConsole.h"
 #include "../StaticFactory.hpp"
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/scoped.h"
 #include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
 
 using namespace std;
 using namespace cinder;
@@ -33,6 +35,8 @@ using namespace v8;
 
 namespace cjs {
 
+gl::PboRef TextureModule::sUploadPbo;
+
 void TextureModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
@@ -89,6 +93,106 @@ void TextureModule::bind(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 
+/**
+ * loadAsync( handle, path, callback )
+ * Decodes the image on the worker pool, then uploads it on the GL worker through a PBO
+ * into a mipmapped texture. The GL worker waits for a fence before the texture is handed
+ * to js, so it is complete when used from any context. Calls back with the next frame as callback(err).
+ * Returns an error message without calling back if the asset does not exist, so nothing is queued
+ * from the script thread itself.
+ */
+void TextureModule::loadAsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  if(!args[0]->IsObject() || !args[2]->IsFunction()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "loadAsync needs a handle, a path and a callback")));
+    return;
+  }
+  
+  // Shares resources with the context current on the calling thread (main or background context)
+  WorkerPool& uploader = PipeModule::getGLWorker();
+  
+  v8::String::Utf8Value utf8Path(args[1]->ToString());
+  fs::path path = getApp()->getAssetPath(fs::path(*utf8Path));
+  std::string name(*utf8Path);
+  
+  std::shared_ptr<v8::Persistent<v8::Object>> handle(new v8::Persistent<v8::Object>(isolate, args[0]->ToObject()));
+  NextFrameFn nffn(new NextFrameFnHolder());
+  nffn->v8Fn.Reset(isolate, args[2].As<Function>());
+  
+  // Called on the workers, the result reaches js with the next frame
+  auto done = [nffn, handle](gl::TextureRef tex, std::string error){
+    nffn->complete = [handle, tex, error](Isolate* isolate, Local<Function> callback){
+      Local<Value> argv[1] = { v8::Null(isolate) };
+      if(tex){
+        StaticFactory::put<Texture>( isolate, tex, Local<Object>::New(isolate, *handle) );
+      } else {
+        argv[0] = v8::Exception::Error(v8::String::NewFromUtf8(isolate, error.c_str()));
+      }
+      handle->Reset();
+      callback->Call(callback->CreationContext()->Global(), 1, argv);
+    };
+    PipeModule::nextFrame(nffn);
+  };
+  
+  if(path.empty()){
+    nffn->v8Fn.Reset();
+    handle->Reset();
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, ("Texture not found: " + name).c_str()));
+    return;
+  }
+  
+  // Decode
+  PipeModule::getWorkerPool().submit([path, done, &uploader](){
+    std::shared_ptr<Surface8u> surface;
+    try {
+      surface.reset(new Surface8u(loadImage(loadFile(path)), SurfaceConstraintsDefault(), true));
+    } catch(std::exception &ex){
+      done(gl::TextureRef(), ex.what());
+      return;
+    }
+    
+    // Upload
+    uploader.submit([surface, done](){
+      int32_t width = surface->getWidth();
+      int32_t height = surface->getHeight();
+      size_t rowBytes = width * 4;
+      size_t size = rowBytes * height;
+      
+      // The PBO is reused, the previous upload has completed (fence below)
+      if(!sUploadPbo || sUploadPbo->getSize() < size){
+        sUploadPbo = gl::Pbo::create(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+      }
+      
+      uint8_t* dst = (uint8_t*)sUploadPbo->mapBufferRange(0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if(!dst){
+        done(gl::TextureRef(), "Texture upload failed, could not map PBO");
+        return;
+      }
+      for(int32_t y = 0; y < height; y++){
+        memcpy(dst + y * rowBytes, surface->getData(ivec2(0, y)), rowBytes);
+      }
+      sUploadPbo->unmap();
+      
+      gl::TextureRef tex = gl::Texture::create(width, height, Texture::Format().mipmap().internalFormat(GL_RGBA8));
+      tex->update(sUploadPbo, GL_RGBA, GL_UNSIGNED_BYTE);
+      tex->setTopDown(true);
+      {
+        gl::ScopedTextureBind bind(tex);
+        glGenerateMipmap(tex->getTarget());
+      }
+      
+      GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      glDeleteSync(fence);
+      
+      done(tex, "");
+    });
+  });
+}
+
 /**
  * Add JS bindings
  */
@@ -99,6 +203,7 @@ void TextureModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   textureTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "create"), v8::FunctionTemplate::New(getIsolate(), create));
   textureTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroy"), v8::FunctionTemplate::New(getIsolate(), destroy));
   textureTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "bind"), v8::FunctionTemplate::New(getIsolate(), bind));
+  textureTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "loadAsync"), v8::FunctionTemplate::New(getIsolate(), loadAsync));
   
   
   // Expose global texture object
@@ -27,6 +27,8 @@
 #define TEXTURE_MOD_ID 11
 
 #include "../PipeModule.hpp"
+#include "cinder/gl/Context.h"
+#include "cinder/gl/Pbo.h"
 
 namespace cjs {
   
@@ -46,9 +48,13 @@ class TextureModule : public PipeModule {
     static void create(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void bind(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void loadAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     void loadGlobalJS( v8::Local<v8::ObjectTemplate> &global );
   
+  private:
+    // Reused by uploads on the GL worker (see loadAsync)
+    static cinder::gl::PboRef sUploadPbo;
  };
   
 } // namespace cjs
@@ -25,6 +25,8 @@
 #include "../StaticFactory.hpp"
 #include "cinder/gl/Vbo.h"
 
+#include <map>
+
 using namespace std;
 using namespace cinder;
 using namespace cinder::gl;
@@ -32,6 +34,53 @@ using namespace v8;
 
 namespace cjs {
 
+//
+// Mapped buffers
+// The ArrayBuffer handed out by map() is tracked with the Vbo it views. The mapping keeps the Vbo
+// alive, so a collected or destroyed holder can not free the memory under a living view.
+// The view is neutered on unmap and destroy, a view that is collected while mapped unmaps the Vbo.
+struct Mapping {
+  VboRef vbo;
+  v8::Persistent<v8::ArrayBuffer> buffer;
+};
+
+static std::map<Vbo*, std::unique_ptr<Mapping>> sMappings;
+
+static void releaseMapping( Vbo* vbo ){
+  auto it = sMappings.find(vbo);
+  if(it == sMappings.end()){
+    return;
+  }
+  
+  Mapping* mapping = it->second.get();
+  if(!mapping->buffer.IsEmpty()){
+    v8::Isolate* isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    Local<ArrayBuffer> buffer = Local<ArrayBuffer>::New(isolate, mapping->buffer);
+    if(buffer->IsNeuterable()){
+      buffer->Neuter();
+    }
+    mapping->buffer.Reset();
+  }
+  mapping->vbo->unmap();
+  sMappings.erase(it);
+}
+
+static void mappingWeakCallback( const v8::WeakCallbackData<v8::ArrayBuffer, Mapping>& data ){
+  Mapping* mapping = data.GetParameter();
+  mapping->buffer.Reset();
+  releaseMapping(mapping->vbo.get());
+}
+
+// bufferData implicitly unmaps, storage can only be re-specified while nothing views it
+static bool throwIfMapped( v8::Isolate* isolate, const VboRef& vbo ){
+  if(sMappings.find(vbo.get()) == sMappings.end()){
+    return false;
+  }
+  isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, "Vbo is mapped, unmap it first")));
+  return true;
+}
+
 void VBOModule::create(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::Isolate* isolate = args.GetIsolate();
   v8::HandleScope scope(isolate);
@@ -76,9 +125,11 @@ void VBOModule::destroy(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
 
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    StaticFactory::remove<Vbo>(isolate, id);
+    VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+    if(vbo){
+      releaseMapping(vbo.get());
+    }
+    StaticFactory::remove<Vbo>(isolate, args[0]);
   }
   
   return;
@@ -89,9 +140,7 @@ void VBOModule::bind(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
   
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    VboRef vbo = StaticFactory::get<Vbo>(id);
+    VboRef vbo = StaticFactory::get<Vbo>(args[0]);
     
     if(!vbo){
       isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
@@ -107,9 +156,7 @@ void VBOModule::unbind(const v8::FunctionCallbackInfo<v8::Value>& args) {
   v8::HandleScope scope(isolate);
   
   if(!args[0].IsEmpty()){
-    uint32_t id = args[0]->ToUint32()->Value();
-    
-    VboRef vbo = StaticFactory::get<Vbo>(id);
+    VboRef vbo = StaticFactory::get<Vbo>(args[0]);
     
     if(!vbo){
       isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
@@ -121,6 +168,193 @@ void VBOModule::unbind(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 
+/**
+ * update( handle, typedArray, byteOffset, orphan )
+ * Uploads straight from the typed array backing store (glBufferSubData).
+ * Grows the buffer if data written at offset 0 does not fit.
+ */
+void VBOModule::update(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  if(!args[1]->IsArrayBufferView()){
+    isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate, "Need a typed array to update the Vbo")));
+    return;
+  }
+  
+  if(throwIfMapped(isolate, vbo)){
+    return;
+  }
+  
+  Local<ArrayBufferView> data = args[1].As<ArrayBufferView>();
+  const char* bytes = static_cast<char*>(data->Buffer()->GetContents().Data()) + data->ByteOffset();
+  GLsizeiptr byteLength = data->ByteLength();
+  GLintptr byteOffset = args[2]->IsUndefined() ? 0 : args[2]->Uint32Value();
+  
+  if(byteOffset + byteLength > vbo->getSize()){
+    if(byteOffset > 0){
+      isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Update exceeds Vbo size")));
+      return;
+    }
+    vbo->bufferData(byteLength, bytes, vbo->getUsage());
+    return;
+  }
+  
+  // Orphan first, so the driver does not stall on a buffer that is still in use
+  if(args[3]->BooleanValue()){
+    vbo->bufferData(vbo->getSize(), nullptr, vbo->getUsage());
+  }
+  
+  vbo->bufferSubData(byteOffset, byteLength, bytes);
+  
+  return;
+}
+
+/**
+ * orphan( handle )
+ * Re-specifies the storage with the same size and usage and no data.
+ */
+void VBOModule::orphan(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  if(throwIfMapped(isolate, vbo)){
+    return;
+  }
+  
+  vbo->bufferData(vbo->getSize(), nullptr, vbo->getUsage());
+  
+  return;
+}
+
+/**
+ * map( handle, access ) -> ArrayBuffer
+ * Maps the whole buffer with glMapBufferRange and returns an external ArrayBuffer
+ * on the mapped memory. It is only valid until unmap( handle ) or destroy( handle ),
+ * update and orphan throw while the buffer is mapped.
+ */
+void VBOModule::map(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::EscapableHandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  if(sMappings.find(vbo.get()) != sMappings.end()){
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, "Vbo is already mapped")));
+    return;
+  }
+  
+  GLbitfield access = args[1]->IsUndefined() ? (GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) : args[1]->Uint32Value();
+  
+  void* ptr = vbo->mapBufferRange(0, vbo->getSize(), access);
+  
+  if(!ptr){
+    isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, "Vbo could not be mapped")));
+    return;
+  }
+  
+  // Externalized, v8 does not free the mapped memory
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, ptr, vbo->getSize());
+  
+  Mapping* mapping = new Mapping();
+  mapping->vbo = vbo;
+  mapping->buffer.Reset(isolate, buffer);
+  mapping->buffer.SetWeak(mapping, mappingWeakCallback);
+  sMappings[vbo.get()].reset(mapping);
+  
+  args.GetReturnValue().Set(scope.Escape(buffer));
+}
+
+/**
+ * unmap( handle )
+ * Neuters the ArrayBuffer returned by map, so js can not touch unmapped memory.
+ */
+void VBOModule::unmap(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  releaseMapping(vbo.get());
+  
+  return;
+}
+
+/**
+ * bindBase( handle, index, byteOffset, byteSize )
+ * Binds the buffer to a uniform buffer binding point, the whole buffer without offset and size.
+ * Binding points are context state, so data uploaded once serves all programs using the index.
+ */
+void VBOModule::bindBase(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  GLuint index = args[1]->Uint32Value();
+  
+  if(args[2]->IsUndefined()){
+    glBindBufferBase(GL_UNIFORM_BUFFER, index, vbo->getId());
+    return;
+  }
+  
+  GLintptr byteOffset = args[2]->Uint32Value();
+  GLsizeiptr byteSize = args[3]->IsUndefined() ? vbo->getSize() - byteOffset : args[3]->Uint32Value();
+  
+  if(byteOffset + byteSize > vbo->getSize()){
+    isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8(isolate, "Range exceeds Vbo size")));
+    return;
+  }
+  
+  glBindBufferRange(GL_UNIFORM_BUFFER, index, vbo->getId(), byteOffset, byteSize);
+}
+
+/**
+ * getSize( handle ) -> byte size of the buffer storage
+ */
+void VBOModule::getSize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  
+  VboRef vbo = StaticFactory::get<Vbo>(args[0]);
+  
+  if(!vbo){
+    isolate->ThrowException(v8::Exception::ReferenceError(v8::String::NewFromUtf8(isolate, "Vbo does not exist")));
+    return;
+  }
+  
+  args.GetReturnValue().Set(v8::Uint32::New(isolate, (uint32_t)vbo->getSize()));
+}
+
 /**
  * Add JS bindings
  */
@@ -132,6 +366,19 @@ void VBOModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "destroy"), v8::FunctionTemplate::New(getIsolate(), destroy));
   objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "bind"), v8::FunctionTemplate::New(getIsolate(), bind));
   objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "unbind"), v8::FunctionTemplate::New(getIsolate(), unbind));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "getSize"), v8::FunctionTemplate::New(getIsolate(), getSize));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "update"), v8::FunctionTemplate::New(getIsolate(), update));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "orphan"), v8::FunctionTemplate::New(getIsolate(), orphan));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "map"), v8::FunctionTemplate::New(getIsolate(), map));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "unmap"), v8::FunctionTemplate::New(getIsolate(), unmap));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "bindBase"), v8::FunctionTemplate::New(getIsolate(), bindBase));
+  
+  // Map access bits
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "MAP_READ_BIT"), v8::Uint32::New(getIsolate(), GL_MAP_READ_BIT));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "MAP_WRITE_BIT"), v8::Uint32::New(getIsolate(), GL_MAP_WRITE_BIT));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "MAP_INVALIDATE_RANGE_BIT"), v8::Uint32::New(getIsolate(), GL_MAP_INVALIDATE_RANGE_BIT));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "MAP_INVALIDATE_BUFFER_BIT"), v8::Uint32::New(getIsolate(), GL_MAP_INVALIDATE_BUFFER_BIT));
+  objTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "MAP_UNSYNCHRONIZED_BIT"), v8::Uint32::New(getIsolate(), GL_MAP_UNSYNCHRONIZED_BIT));
   
   
   // Expose global object
@@ -47,6 +47,16 @@ class VBOModule : public PipeModule {
     static void destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void bind(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void unbind(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getSize(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
+    // Streaming
+    static void update(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void orphan(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void map(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void unmap(const v8::FunctionCallbackInfo<v8::Value>& args);
+  
+    // Uniform blocks
+    static void bindBase(const v8::FunctionCallbackInfo<v8::Value>& args);
   
     void loadGlobalJS( v8::Local<v8::ObjectTemplate> &global );
     
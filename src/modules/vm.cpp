@@ -22,6 +22,7 @@
 
 #include "vm.hpp"
 #include "AppConsole.h"
+#include "CodeCache.hpp"
 
 #include "cinder/Filesystem.h"
 
@@ -50,8 +51,19 @@ void runInThisContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
   
   TryCatch try_catch;
   
-  // Compile the source code.
-  Local<Script> script = Script::Compile( source, filename );
+  // Compile the source code, through the code cache if filename is a file on disk.
+  // The cache file is named after the path, the mtime goes into the validation hash.
+  Local<Script> script;
+  v8::String::Utf8Value path(filename);
+  boost::system::error_code ec;
+  std::time_t mtime = fs::last_write_time(fs::path(*path), ec);
+  if(!ec && !CodeCache::getDirectory().empty()){
+    char key[9];
+    snprintf(key, sizeof(key), "%08x", CodeCache::hash(*path, path.length()));
+    script = CodeCache::compile( isolate, source, filename, CodeCache::SCRIPT, key, (uint32_t)mtime );
+  } else {
+    script = Script::Compile( source, filename );
+  }
   
   if(try_catch.HasCaught()){
     std::string except = "External module compile error, in ";
@@ -72,7 +84,7 @@ void runInThisContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
       except.append(*msg);
     }
     
-    AppConsole::log(except);
+    AppConsole::log(except, LOG_ERROR);
     isolate->ThrowException(v8::Exception::Error(String::NewFromUtf8(isolate, except.c_str())));
     return;
   }
@@ -91,7 +103,7 @@ void runInThisContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
       except.append(*msg);
     }
     
-    AppConsole::log(except);
+    AppConsole::log(except, LOG_ERROR);
     isolate->ThrowException(v8::Exception::Error(String::NewFromUtf8(isolate, except.c_str())));
     // TODO: remove from module list again
     return;
@@ -102,6 +114,28 @@ void runInThisContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
   return;
 }
 
+static Local<Object> cacheStatsObject( Isolate* isolate, const CodeCache::Stats& stats ){
+  Local<Object> obj = Object::New(isolate);
+  obj->Set(v8::String::NewFromUtf8(isolate, "hits"), v8::Uint32::New(isolate, stats.hits));
+  obj->Set(v8::String::NewFromUtf8(isolate, "misses"), v8::Uint32::New(isolate, stats.misses));
+  obj->Set(v8::String::NewFromUtf8(isolate, "rejected"), v8::Uint32::New(isolate, stats.rejected));
+  return obj;
+}
+
+/**
+ * Code cache counters for user modules (and natives)
+ * @return {hits, misses, rejected, natives: {hits, misses, rejected}}
+ */
+void getCacheStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  
+  Local<Object> result = cacheStatsObject(isolate, CodeCache::getStats(CodeCache::SCRIPT));
+  result->Set(v8::String::NewFromUtf8(isolate, "natives"), cacheStatsObject(isolate, CodeCache::getStats(CodeCache::NATIVE)));
+  
+  args.GetReturnValue().Set(result);
+}
+
 /**
  * Add JS bindings
  */
@@ -110,6 +144,7 @@ void VMModule::loadGlobalJS( v8::Local<v8::ObjectTemplate> &global ) {
   Handle<ObjectTemplate> vmTemplate = ObjectTemplate::New(getIsolate());
   
   vmTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "runInThisContext"), v8::FunctionTemplate::New(getIsolate(), runInThisContext));
+  vmTemplate->Set(v8::String::NewFromUtf8(getIsolate(), "getCacheStats"), v8::FunctionTemplate::New(getIsolate(), getCacheStats));
   
   // Expose global vm object
   global->Set(v8::String::NewFromUtf8(getIsolate(), "_vm"), vmTemplate);
@@ -0,0 +1,330 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "GlyphText.hpp"
+#include "AppConsole.h"
+#include "cinder/gl/scoped.h"
+#include "cinder/Text.h"
+#include "cinder/Unicode.h"
+
+using namespace std;
+using namespace cinder;
+
+namespace cjs {
+
+GlyphAtlas::GlyphAtlas( const Font &font, int pageSize )
+  : mFont(font), mPacker(pageSize, pageSize), mGeneration(1)
+{
+  resetPage(pageSize);
+  mLineHeight = ceilf(font.getAscent() + font.getDescent() + font.getLeading());
+}
+
+GlyphAtlasRef GlyphAtlas::getDefault() {
+  static GlyphAtlasRef sDefault( new GlyphAtlas( Font::getDefault() ) );
+  return sDefault;
+}
+
+void GlyphAtlas::resetPage( int pageSize ) {
+  mPacker = SkylinePacker(pageSize, pageSize);
+  mPage = Surface8u(pageSize, pageSize, true, SurfaceChannelOrder::RGBA);
+  memset(mPage.getData(), 0, mPage.getRowBytes() * mPage.getHeight());
+  mGlyphs.clear();
+  mDirty = true;
+}
+
+bool GlyphAtlas::getGlyph( char32_t c, Glyph* glyph ) {
+  std::string fullMessage;
+  
+  {
+    std::lock_guard<std::mutex> lck( mMutex );
+    
+    auto it = mGlyphs.find(c);
+    if(it != mGlyphs.end()){
+      *glyph = it->second;
+      return true;
+    }
+    
+    TextLayout layout;
+    layout.clear( ColorA( 0, 0, 0, 0 ) );
+    layout.setFont( mFont );
+    layout.setColor( ColorA( 1, 1, 1, 1 ) );
+    layout.addLine( toUtf8( std::u32string( 1, c ) ) );
+    Surface8u cell = layout.render( true, false );
+    
+    // One pixel padding, so linear filtering does not bleed in neighbours
+    int x, y;
+    if(!mPacker.insert(cell.getWidth() + 2, cell.getHeight() + 2, &x, &y)){
+      int size = mPacker.getWidth();
+      if(size < kMaxPageSize){
+        size = std::min(size * 2, kMaxPageSize);
+      } else if(!mFullLogged){
+        mFullLogged = true;
+        fullMessage = "Glyph atlas is full at " + std::to_string(size) + "x" + std::to_string(size) + ", cached glyphs are dropped";
+      }
+      resetPage(size);
+      mGeneration++;
+      
+      if(!mPacker.insert(cell.getWidth() + 2, cell.getHeight() + 2, &x, &y)){
+        return false;
+      }
+    }
+    x += 1;
+    y += 1;
+    mPage.copyFrom(cell, cell.getBounds(), ivec2(x, y));
+    mDirty = true;
+    
+    float size = (float)mPacker.getWidth();
+    *glyph = {
+      (float)cell.getWidth(), (float)cell.getHeight(),
+      x / size, y / size, (x + cell.getWidth()) / size, (y + cell.getHeight()) / size
+    };
+    mGlyphs[c] = *glyph;
+  }
+  
+  // Outside the atlas lock, the console lays out its rows with this atlas
+  if(!fullMessage.empty()){
+    AppConsole::log(fullMessage, LOG_WARN);
+  }
+  return true;
+}
+
+gl::Texture2dRef GlyphAtlas::getTexture() {
+  std::lock_guard<std::mutex> lck( mMutex );
+  
+  // Created again after the page grew
+  if(!mTexture || mTexture->getWidth() != mPage.getWidth()){
+    mTexture = gl::Texture2d::create(mPage.getWidth(), mPage.getHeight(), gl::Texture2d::Format()
+      .internalFormat(GL_RGBA8)
+      .minFilter(GL_LINEAR)
+      .magFilter(GL_LINEAR)
+    );
+    mDirty = true;
+  }
+  
+  if(mDirty){
+    mDirty = false;
+    mTexture->update(mPage);
+  }
+  
+  return mTexture;
+}
+
+// Vaos of meshes destroyed while another context was current, deleted by the next draw in
+// their own context. Never destroyed, meshes in static storage release theirs during exit.
+struct OrphanVaos {
+  std::mutex mutex;
+  std::vector<std::pair<gl::Context*, gl::VaoRef>> vaos;
+};
+
+static OrphanVaos& orphanVaos() {
+  static OrphanVaos* sOrphans = new OrphanVaos();
+  return *sOrphans;
+}
+
+TextMesh::~TextMesh() {
+  gl::Context* context = gl::context();
+  for(auto& entry : mVaos){
+    if(entry.first != context && entry.second.vao){
+      OrphanVaos& orphans = orphanVaos();
+      std::lock_guard<std::mutex> lck( orphans.mutex );
+      orphans.vaos.push_back(std::make_pair(entry.first, entry.second.vao));
+    }
+  }
+}
+
+void TextMesh::setText( const std::string &text ) {
+  if(text == mText && !mVertices.empty()){
+    return;
+  }
+  mText = text;
+  rebuild();
+}
+
+void TextMesh::setText( const std::string &text, const ColorA &color ) {
+  if(text == mText && color == mColor && !mVertices.empty()){
+    return;
+  }
+  mText = text;
+  mColor = color;
+  rebuild();
+}
+
+void TextMesh::setColor( const ColorA &color ) {
+  if(color == mColor){
+    return;
+  }
+  mColor = color;
+  rebuild();
+}
+
+void TextMesh::rebuild() {
+  if(!mAtlas){
+    mAtlas = GlyphAtlas::getDefault();
+  }
+  
+  mAtlasGeneration = mAtlas->getGeneration();
+  std::u32string chars = toUtf32( mText );
+  float lineHeight = mAtlas->getLineHeight();
+  float x = 0;
+  float y = 0;
+  
+  mVertices.clear();
+  mSize = vec2( 0, chars.empty() ? 0 : lineHeight );
+  
+  for(char32_t c : chars){
+    if(c == '\n'){
+      x = 0;
+      y += lineHeight;
+      mSize.y = y + lineHeight;
+      continue;
+    }
+    
+    GlyphAtlas::Glyph glyph;
+    if(!mAtlas->getGlyph(c, &glyph)){
+      continue;
+    }
+    
+    float x1 = x + glyph.width;
+    float y1 = y + glyph.height;
+    const float quad[6][4] = {
+      { x,  y,  glyph.u0, glyph.v0 },
+      { x1, y,  glyph.u1, glyph.v0 },
+      { x1, y1, glyph.u1, glyph.v1 },
+      { x,  y,  glyph.u0, glyph.v0 },
+      { x1, y1, glyph.u1, glyph.v1 },
+      { x,  y1, glyph.u0, glyph.v1 }
+    };
+    for(int i = 0; i < 6; i++){
+      mVertices.insert(mVertices.end(), quad[i], quad[i] + 4);
+      mVertices.insert(mVertices.end(), { mColor.r, mColor.g, mColor.b, mColor.a });
+    }
+    
+    x = x1;
+    mSize.x = std::max(mSize.x, x);
+  }
+  
+  mVertexCount = mVertices.size() / kFloatsPerVertex;
+  mChanged = true;
+}
+
+/**
+ * Uploads only the span between the first and the last float that differs from the last upload,
+ * the buffer is reallocated (with headroom) only when the text outgrows it.
+ */
+void TextMesh::upload() {
+  mChanged = false;
+  size_t byteLength = mVertices.size() * sizeof(float);
+  
+  if(!mVbo || mVbo->getSize() < byteLength){
+    mVbo = gl::Vbo::create(GL_ARRAY_BUFFER, byteLength * 2, nullptr, GL_DYNAMIC_DRAW);
+    mVbo->bufferSubData(0, byteLength, mVertices.data());
+    mUploaded = mVertices;
+    return;
+  }
+  
+  size_t common = std::min(mVertices.size(), mUploaded.size());
+  size_t first = 0;
+  while(first < common && mVertices[first] == mUploaded[first]){
+    first++;
+  }
+  
+  size_t end = mVertices.size();
+  if(end == mUploaded.size()){
+    while(end > first && mVertices[end - 1] == mUploaded[end - 1]){
+      end--;
+    }
+  }
+  
+  if(end > first){
+    mVbo->bufferSubData(first * sizeof(float), (end - first) * sizeof(float), mVertices.data() + first);
+  }
+  mUploaded = mVertices;
+}
+
+void TextMesh::draw() {
+  // Glyphs were dropped or moved since the layout
+  if(mAtlas && mAtlasGeneration != mAtlas->getGeneration()){
+    rebuild();
+  }
+  
+  if(mVertexCount == 0){
+    return;
+  }
+  
+  if(mChanged){
+    upload();
+  }
+  
+  gl::Texture2dRef texture = mAtlas->getTexture();
+  gl::GlslProgRef shader = gl::getStockShader( gl::ShaderDef().texture().color() );
+  gl::Context* context = gl::context();
+  
+  // Vaos released by meshes destroyed while another context was current
+  {
+    OrphanVaos& orphans = orphanVaos();
+    std::lock_guard<std::mutex> lck( orphans.mutex );
+    for(size_t i = 0; i < orphans.vaos.size();){
+      if(orphans.vaos[i].first == context){
+        orphans.vaos[i] = orphans.vaos.back();
+        orphans.vaos.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+  
+  // The console and SimpleText may draw from different contexts, the buffer is shared between them
+  ContextVao& entry = mVaos[context];
+  if(!entry.vao){
+    entry.vao = gl::Vao::create();
+  }
+  
+  if(entry.vbo != mVbo){
+    entry.vbo = mVbo;
+    
+    gl::ScopedVao scopedVao( entry.vao );
+    gl::ScopedBuffer scopedVbo( mVbo );
+    GLsizei stride = kFloatsPerVertex * sizeof(float);
+    
+    int position = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
+    int texCoord = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
+    int color = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
+    
+    gl::enableVertexAttribArray( position );
+    gl::vertexAttribPointer( position, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)0 );
+    gl::enableVertexAttribArray( texCoord );
+    gl::vertexAttribPointer( texCoord, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(2 * sizeof(float)) );
+    gl::enableVertexAttribArray( color );
+    gl::vertexAttribPointer( color, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(4 * sizeof(float)) );
+  }
+  
+  gl::ScopedVao scopedVao( entry.vao );
+  gl::ScopedGlslProg scopedShader( shader );
+  gl::ScopedTextureBind scopedTexture( texture, 0 );
+  gl::ScopedBlendAlpha scopedBlend;
+  shader->uniform( "uTex0", 0 );
+  
+  gl::setDefaultShaderVars();
+  gl::drawArrays( GL_TRIANGLES, 0, (GLsizei)mVertexCount );
+}
+
+} // namespace cjs
@@ -0,0 +1,150 @@
+/*
+ Copyright (c) Sebastian Herrlinger - All rights reserved.
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+ 
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+ 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _GlyphText_hpp_
+#define _GlyphText_hpp_
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Vao.h"
+#include "cinder/Surface.h"
+#include "cinder/Font.h"
+#include "SkylinePacker.h"
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+
+namespace cjs {
+
+//
+// Bitmap glyph cache, each character is rasterized once (white, alpha coverage) and packed
+// into a single texture page. New glyphs are uploaded with the next draw that needs them.
+// Glyphs are laid out by their rendered cell width, no kerning.
+// A full page is doubled up to kMaxPageSize, after that it is cleared (logged once). Both start
+// a new generation, meshes laid out in an older one lay themselves out again.
+class GlyphAtlas {
+  public:
+    struct Glyph {
+      float width;
+      float height;
+      float u0, v0, u1, v1;
+    };
+  
+    GlyphAtlas( const cinder::Font &font, int pageSize = 512 );
+  
+    // Shared atlas with the default font, used by the console, overlay and SimpleText
+    static std::shared_ptr<GlyphAtlas> getDefault();
+  
+    // Rasterizes the character on first use, false if it does not fit an empty page
+    bool getGlyph( char32_t c, Glyph* glyph );
+  
+    // Uploads pending glyphs and returns the page texture, needs a GL context
+    cinder::gl::Texture2dRef getTexture();
+  
+    inline float getLineHeight() const {
+      return mLineHeight;
+    }
+  
+    inline uint32_t getGeneration() const {
+      return mGeneration;
+    }
+  
+  private:
+    static const int kMaxPageSize = 2048;
+  
+    // With the lock held, drops all glyphs and starts an empty page
+    void resetPage( int pageSize );
+  
+    cinder::Font mFont;
+    SkylinePacker mPacker;
+    cinder::Surface8u mPage;
+    cinder::gl::Texture2dRef mTexture;
+    std::unordered_map<char32_t, Glyph> mGlyphs;
+    std::mutex mMutex;
+    float mLineHeight;
+    bool mDirty = false;
+    bool mFullLogged = false;
+    std::atomic<uint32_t> mGeneration;
+};
+typedef std::shared_ptr<GlyphAtlas> GlyphAtlasRef;
+
+//
+// Vertex buffered text, setText only rebuilds the quads on the cpu and uploads the range
+// of vertices that actually changed, so a counter ticking only rewrites a few vertices.
+class TextMesh {
+  public:
+    // Without an atlas the default one is used, resolved on first use (the console mesh is static)
+    TextMesh( GlyphAtlasRef atlas = nullptr ) : mAtlas(atlas) {}
+    ~TextMesh();
+  
+    void setText( const std::string &text );
+    void setColor( const cinder::ColorA &color );
+  
+    // Both at once, laid out a single time
+    void setText( const std::string &text, const cinder::ColorA &color );
+    void draw();
+  
+    inline const std::string& getText() const {
+      return mText;
+    }
+  
+    inline cinder::vec2 getSize() const {
+      return mSize;
+    }
+  
+  private:
+    // x, y, u, v, r, g, b, a
+    static const int kFloatsPerVertex = 8;
+  
+    void rebuild();
+    void upload();
+  
+    GlyphAtlasRef mAtlas;
+    uint32_t mAtlasGeneration = 0;
+    std::string mText;
+    cinder::ColorA mColor = cinder::ColorA( 1, 1, 1, 1 );
+    cinder::vec2 mSize;
+  
+    std::vector<float> mVertices;
+    std::vector<float> mUploaded;
+    size_t mVertexCount = 0;
+    bool mChanged = false;
+  
+    cinder::gl::VboRef mVbo;
+  
+    // Vaos are per context, each is only ever created, set up and deleted with its own context current
+    struct ContextVao {
+      cinder::gl::VaoRef vao;
+      cinder::gl::VboRef vbo; // the buffer the attribute pointers were set up for
+    };
+    std::unordered_map<cinder::gl::Context*, ContextVao> mVaos;
+};
+typedef std::shared_ptr<TextMesh> TextMeshRef;
+
+} // namespace cjs
+
+#endif
@@ -0,0 +1,121 @@
+//
+//  SkylinePacker.h
+//  cinderjs
+//
+//  Bottom-left skyline rectangle packer for texture atlas pages.
+//  The skyline is the list of top edges of the placed rectangles, a new rectangle goes to the
+//  lowest position it fits at (ties go to the narrowest segment), then the skyline is raised
+//  below it and neighbouring segments of equal height are merged.
+//
+
+#ifndef __cinderjs__SkylinePacker__
+#define __cinderjs__SkylinePacker__
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace cjs {
+
+class SkylinePacker {
+  public:
+  SkylinePacker( int width, int height ) : mWidth(width), mHeight(height) {
+    mSkyline.push_back({ 0, 0, width });
+  }
+
+  // Finds a place for a w x h rectangle, false if the page is full
+  bool insert( int w, int h, int* outX, int* outY ) {
+    int bestIndex = -1;
+    int bestY = std::numeric_limits<int>::max();
+    int bestWidth = std::numeric_limits<int>::max();
+
+    for(size_t i = 0; i < mSkyline.size(); i++){
+      int y;
+      if(fits(i, w, h, &y) && (y < bestY || (y == bestY && mSkyline[i].width < bestWidth))){
+        bestIndex = (int)i;
+        bestY = y;
+        bestWidth = mSkyline[i].width;
+      }
+    }
+
+    if(bestIndex < 0){
+      return false;
+    }
+
+    *outX = mSkyline[bestIndex].x;
+    *outY = bestY;
+    place(bestIndex, *outX, bestY + h, w);
+    return true;
+  }
+
+  int getWidth() const { return mWidth; }
+  int getHeight() const { return mHeight; }
+
+  private:
+  struct Segment {
+    int x;
+    int y;
+    int width;
+  };
+
+  // Can a w x h rectangle sit on segment index (spanning following segments)? y is where it sits.
+  bool fits( size_t index, int w, int h, int* y ) const {
+    int x = mSkyline[index].x;
+    if(x + w > mWidth){
+      return false;
+    }
+
+    int top = 0;
+    int remaining = w;
+    for(size_t i = index; remaining > 0; i++){
+      if(i >= mSkyline.size()){
+        return false;
+      }
+      top = std::max(top, mSkyline[i].y);
+      if(top + h > mHeight){
+        return false;
+      }
+      remaining -= mSkyline[i].width;
+    }
+
+    *y = top;
+    return true;
+  }
+
+  void place( int index, int x, int top, int w ) {
+    mSkyline.insert(mSkyline.begin() + index, { x, top, w });
+
+    // Shrink or remove the segments now covered by the new one
+    for(size_t i = index + 1; i < mSkyline.size(); i++){
+      int end = mSkyline[i - 1].x + mSkyline[i - 1].width;
+      if(mSkyline[i].x >= end){
+        break;
+      }
+      int shrink = end - mSkyline[i].x;
+      mSkyline[i].x += shrink;
+      mSkyline[i].width -= shrink;
+      if(mSkyline[i].width > 0){
+        break;
+      }
+      mSkyline.erase(mSkyline.begin() + i);
+      i--;
+    }
+
+    // Merge neighbours of equal height
+    for(size_t i = 0; i + 1 < mSkyline.size(); i++){
+      if(mSkyline[i].y == mSkyline[i + 1].y){
+        mSkyline[i].width += mSkyline[i + 1].width;
+        mSkyline.erase(mSkyline.begin() + i + 1);
+        i--;
+      }
+    }
+  }
+
+  int mWidth;
+  int mHeight;
+  std::vector<Segment> mSkyline;
+};
+
+} // namespace cjs
+
+#endif /* defined(__cinderjs__SkylinePacker__) */
@@ -21,9 +21,8 @@
 */
  
 #include "cinder/gl/gl.h"
-#include "cinder/gl/Texture.h"
-#include "cinder/Text.h"
 #include "cinder/Vector.h"
+#include "GlyphText.hpp"
 
 using namespace std;
 using namespace cinder;
@@ -58,26 +57,20 @@ namespace cjs {
       SimpleText(){}
       ~SimpleText(){}
     
+      // Glyphs come from the shared atlas, changing the text only rewrites vertices
       inline void setText( std::string s ) {
-        _text = s;
-        
-        // Prepare surface for rendering
-        TextLayout tl;
-        tl.setColor( ColorA( 1, 1, 1, 1 ) );
-        tl.addLine( _text );
-        _texture = gl::Texture::create( tl.render() );
+        _mesh.setText( s );
       }
     
       inline void draw() {
         gl::pushMatrices();
         gl::translate( pos );
-        gl::draw( _texture );
+        _mesh.draw();
         gl::popMatrices();
       }
     
     private:
-      std::string _text;
-      gl::Texture2dRef _texture;
+      TextMesh _mesh;
 
   };
   
@@ -0,0 +1,137 @@
+//
+//  benchmark.hpp
+//  FactoryTest
+//
+//  Compares put/get/remove throughput of the StaticFactory slot table
+//  against the previous std::map<uint32_t, boost::any> implementation.
+//
+
+#ifndef _FactoryBenchmark_hpp_
+#define _FactoryBenchmark_hpp_
+
+#include <map>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+#include <boost/any.hpp>
+
+#include "v8.h"
+#include "StaticFactory.hpp"
+
+namespace bench {
+
+class BenchObject {
+  public:
+  int value = 0;
+};
+
+//
+// The former StaticFactory storage, kept here as the baseline
+class MapFactory {
+  template<class T>
+  class Wrapper {
+    public:
+    uint32_t id;
+    std::shared_ptr<T> value;
+    v8::Persistent<v8::Object> handle;
+    ~Wrapper(){ handle.Reset(); }
+  };
+
+  public:
+  template<class T>
+  static void put( v8::Isolate* isolate, std::shared_ptr<T> value, v8::Handle<v8::Object> idHolder ){
+    std::shared_ptr<Wrapper<T>> tuple( new Wrapper<T>() );
+    uint32_t id = ++_sObjectCounter;
+    tuple->id = id;
+    tuple->value = value;
+    idHolder->Set(v8::String::NewFromUtf8(isolate, "id"), v8::Uint32::New(isolate, id));
+    tuple->handle.Reset(isolate, idHolder);
+    _sObjectMap.insert(std::pair<uint32_t, boost::any>(id, tuple));
+  }
+
+  template<class T>
+  static std::shared_ptr<T> get( uint32_t id ){
+    boost::any wrap = _sObjectMap[id];
+    if(wrap.empty()){
+      return std::shared_ptr<T>();
+    }
+    return boost::any_cast<std::shared_ptr<Wrapper<T>>>(wrap)->value;
+  }
+
+  template<class T>
+  static void remove( v8::Isolate* isolate, uint32_t id ){
+    boost::any wrap = _sObjectMap[id];
+    if(!wrap.empty()){
+      _sObjectMap.erase(id);
+    }
+  }
+
+  static std::map<uint32_t, boost::any> _sObjectMap;
+  static uint32_t _sObjectCounter;
+};
+
+std::map<uint32_t, boost::any> MapFactory::_sObjectMap;
+uint32_t MapFactory::_sObjectCounter = 0;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+inline double msSince( Clock::time_point start ){
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//
+// Puts `objects` objects, looks each of them up `lookups` times, then removes them all
+template<class Factory>
+void run( const char* name, v8::Isolate* isolate, int objects, int lookups ){
+  v8::HandleScope handle_scope(isolate);
+
+  std::vector<uint32_t> ids;
+  ids.reserve(objects);
+
+  v8::Local<v8::String> idKey = v8::String::NewFromUtf8(isolate, "id");
+
+  Clock::time_point start = Clock::now();
+  for(int i = 0; i < objects; i++){
+    v8::Local<v8::Object> holder = v8::Object::New(isolate);
+    Factory::template put<BenchObject>(isolate, std::shared_ptr<BenchObject>(new BenchObject()), holder);
+    ids.push_back(holder->Get(idKey)->ToUint32()->Value());
+  }
+  double putMs = msSince(start);
+
+  long sum = 0;
+  start = Clock::now();
+  for(int n = 0; n < lookups; n++){
+    for(int i = 0; i < objects; i++){
+      std::shared_ptr<BenchObject> obj = Factory::template get<BenchObject>(ids[i]);
+      sum += obj->value;
+    }
+  }
+  double getMs = msSince(start);
+
+  start = Clock::now();
+  for(int i = 0; i < objects; i++){
+    Factory::template remove<BenchObject>(isolate, ids[i]);
+  }
+  double removeMs = msSince(start);
+
+  std::cout << name << ": "
+    << objects << " puts " << putMs << "ms / "
+    << (long)objects * lookups << " gets " << getMs << "ms / "
+    << objects << " removes " << removeMs << "ms"
+    << (sum ? " !" : "") << std::endl;
+}
+
+void runAll( v8::Isolate* isolate ){
+  run<MapFactory>("std::map + boost::any", isolate, 10000, 100);
+  run<cjs::StaticFactory>("slot table", isolate, 10000, 100);
+
+  // Second round reuses freed slots in the slot table
+  run<MapFactory>("std::map + boost::any", isolate, 10000, 100);
+  run<cjs::StaticFactory>("slot table", isolate, 10000, 100);
+  std::cout.flush();
+}
+
+} // namespace bench
+
+#endif
@@ -11,6 +11,8 @@
 #include "libplatform/libplatform.h"
 
 #include "StaticFactory.hpp"
+#include "benchmark.hpp"
+#include "slots.hpp"
 
 #include "boost/shared_ptr.hpp"
 
@@ -190,12 +192,28 @@ int main(int argc, const char * argv[]) {
     //wait.
   }
   
+  // Stats of the script runs, the checks and the benchmark below are reported on their own
+  FactoryStats scriptStats = StaticFactory::getStats();
+  
+  //
+  // Slot table checks and slot table vs. map throughput
+  int failures;
+  {
+    Context::Scope context_scope(context);
+    failures = slots::runAll(isolate);
+    bench::runAll(isolate);
+  }
+  
+  std::cout << "Checks and benchmark: "
+    << std::to_string(StaticFactory::getStats().puts - scriptStats.puts) << " puts / "
+    << std::to_string(StaticFactory::getStats().removes - scriptStats.removes) << " removes" << std::endl;
+  
   v8::V8::Dispose();
   std::cout << "After Dispose Factory size: " << std::to_string(StaticFactory::size()) << std::endl;
-  std::cout << std::to_string(StaticFactory::getStats().puts) << " puts / "
-    << std::to_string(StaticFactory::getStats().removes) << " removes" << std::endl;
+  std::cout << std::to_string(scriptStats.puts) << " puts / "
+    << std::to_string(scriptStats.removes) << " removes" << std::endl;
   
   //std::cin.get();
   
-  return 0;
+  return failures ? 1 : 0;
 }
@@ -0,0 +1,162 @@
+//
+//  slots.hpp
+//  FactoryTest
+//
+//  Checks of the StaticFactory slot table: ids removed from js must resolve to nothing,
+//  also after their slot was handed out again, reused slots must never repeat an id
+//  and ids of another type must not resolve.
+//
+
+#ifndef _FactorySlots_hpp_
+#define _FactorySlots_hpp_
+
+#include <set>
+#include <vector>
+#include <iostream>
+
+#include "v8.h"
+#include "StaticFactory.hpp"
+
+namespace slots {
+
+// Own types, so no other test holds ids of them
+class SlotObject {
+  public:
+  int value = 0;
+};
+
+class OtherObject {
+  public:
+  int value = 0;
+};
+
+static int failures = 0;
+
+inline void check( bool ok, const char* what, int line ){
+  if(!ok){
+    failures++;
+    std::cout << "FAILED (slots.hpp:" << line << "): " << what << std::endl;
+  }
+}
+
+#define SLOT_CHECK(cond) check((cond), #cond, __LINE__)
+
+inline uint32_t put( v8::Isolate* isolate, int value ){
+  v8::Local<v8::Object> holder = v8::Object::New(isolate);
+  std::shared_ptr<SlotObject> obj(new SlotObject());
+  obj->value = value;
+  cjs::StaticFactory::put<SlotObject>(isolate, obj, holder);
+  return holder->Get(v8::String::NewFromUtf8(isolate, "id"))->ToUint32()->Value();
+}
+
+inline bool resolves( uint32_t id ){
+  return (bool)cjs::StaticFactory::get<SlotObject>(id);
+}
+
+// Number of failed checks
+int runAll( v8::Isolate* isolate ){
+  v8::HandleScope handle_scope(isolate);
+  failures = 0;
+
+  SLOT_CHECK(!resolves(0));
+
+  // Stale after remove
+  uint32_t first = put(isolate, 1);
+  SLOT_CHECK(first != 0);
+  SLOT_CHECK(resolves(first));
+  SLOT_CHECK(cjs::StaticFactory::get<SlotObject>(first)->value == 1);
+  cjs::StaticFactory::remove<SlotObject>(isolate, first);
+  SLOT_CHECK(!resolves(first));
+
+  // Stale after the slot was reused (the free list hands the same slot out again)
+  uint32_t second = put(isolate, 2);
+  SLOT_CHECK(second != first);
+  SLOT_CHECK(!resolves(first));
+  SLOT_CHECK(resolves(second));
+  SLOT_CHECK(cjs::StaticFactory::get<SlotObject>(second)->value == 2);
+
+  // Removing a stale id must not touch the new occupant
+  cjs::StaticFactory::remove<SlotObject>(isolate, first);
+  SLOT_CHECK(resolves(second));
+  cjs::StaticFactory::remove<SlotObject>(isolate, second);
+  SLOT_CHECK(!resolves(second));
+
+  // Cycling one slot: every put and remove bumps the generation, so 2000 cycles stay
+  // below the 12 bit generation wrap and no id may come back
+  std::set<uint32_t> seen;
+  seen.insert(first);
+  seen.insert(second);
+  bool unique = true;
+  bool allStale = true;
+  std::vector<uint32_t> cycled;
+  for(int i = 0; i < 2000; i++){
+    uint32_t id = put(isolate, i);
+    unique = seen.insert(id).second && id != 0 && unique;
+    cjs::StaticFactory::remove<SlotObject>(isolate, id);
+    cycled.push_back(id);
+  }
+  for(uint32_t id : cycled){
+    allStale = !resolves(id) && allStale;
+  }
+  SLOT_CHECK(unique);
+  SLOT_CHECK(allStale);
+
+  // Ids of another type resolve to nothing, also when replaced or removed as the wrong type
+  uint32_t own = put(isolate, 3);
+  v8::Local<v8::Object> otherHolder = v8::Object::New(isolate);
+  cjs::StaticFactory::put<OtherObject>(isolate, std::shared_ptr<OtherObject>(new OtherObject()), otherHolder);
+  uint32_t other = otherHolder->Get(v8::String::NewFromUtf8(isolate, "id"))->ToUint32()->Value();
+  SLOT_CHECK(other != own);
+  SLOT_CHECK(!cjs::StaticFactory::get<OtherObject>(own));
+  SLOT_CHECK(!resolves(other));
+  SLOT_CHECK(!cjs::StaticFactory::replace<SlotObject>(other, std::shared_ptr<SlotObject>(new SlotObject())));
+  cjs::StaticFactory::remove<OtherObject>(isolate, own);
+  SLOT_CHECK(resolves(own));
+  cjs::StaticFactory::remove<SlotObject>(isolate, other);
+  SLOT_CHECK((bool)cjs::StaticFactory::get<OtherObject>(other));
+  cjs::StaticFactory::remove<SlotObject>(isolate, own);
+  cjs::StaticFactory::remove<OtherObject>(isolate, other);
+
+  // The remove hook runs once, after the id stopped resolving
+  uint32_t hooked = put(isolate, 4);
+  int hookCalls = 0;
+  bool hookSawStale = false;
+  SLOT_CHECK(cjs::StaticFactory::onRemove<SlotObject>(hooked, [&](){
+    hookCalls++;
+    hookSawStale = !resolves(hooked);
+  }));
+  SLOT_CHECK(!cjs::StaticFactory::onRemove<OtherObject>(hooked, [](){}));
+  cjs::StaticFactory::remove<SlotObject>(isolate, hooked);
+  cjs::StaticFactory::remove<SlotObject>(isolate, hooked);
+  SLOT_CHECK(hookCalls == 1);
+  SLOT_CHECK(hookSawStale);
+  SLOT_CHECK(!cjs::StaticFactory::onRemove<SlotObject>(hooked, [](){}));
+
+  // Live objects never share an id, each resolves to its own object
+  std::vector<uint32_t> live;
+  std::set<uint32_t> liveIds;
+  for(int i = 0; i < 1000; i++){
+    live.push_back(put(isolate, i));
+    liveIds.insert(live.back());
+  }
+  SLOT_CHECK(liveIds.size() == live.size());
+  bool ownObjects = true;
+  for(int i = 0; i < (int)live.size(); i++){
+    std::shared_ptr<SlotObject> obj = cjs::StaticFactory::get<SlotObject>(live[i]);
+    ownObjects = obj && obj->value == i && ownObjects;
+  }
+  SLOT_CHECK(ownObjects);
+  for(uint32_t id : live){
+    cjs::StaticFactory::remove<SlotObject>(isolate, id);
+  }
+
+  std::cout << "Slot table checks: " << (failures ? std::to_string(failures) + " failed" : "passed") << std::endl;
+  std::cout.flush();
+  return failures;
+}
+
+#undef SLOT_CHECK
+
+} // namespace slots
+
+#endif
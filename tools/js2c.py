@@ -219,6 +219,7 @@ HEADER_TEMPLATE = """\
  */
 #ifndef js_natives_h
 #define js_natives_h
+#include <string.h>
 namespace cjs {
 
 %(source_lines)s\
@@ -237,6 +238,26 @@ static const struct _native natives[] = {
 
 };
 
+/* natives is sorted by name (strcmp order), the sentinel is not counted */
+static const int natives_count = %(native_count)i;
+
+/**
+ * Binary search for a native by name
+ * @return int index into natives or -1
+ */
+inline int findNative( const char* name ) {
+  int lo = 0;
+  int hi = natives_count;
+  while(lo < hi){
+    int mid = (lo + hi) >> 1;
+    int cmp = strcmp(natives[mid].name, name);
+    if(cmp == 0) return mid;
+    if(cmp < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return -1;
+}
+
 }
 #endif
 """
@@ -306,7 +327,10 @@ def JS2C(source, target):
       ids.append((id, len(lines)))
     source_lines.append(SOURCE_DECLARATION % { 'id': id, 'data': data })
     source_lines_empty.append(SOURCE_DECLARATION % { 'id': id, 'data': 0 })
-    native_lines.append(NATIVE_DECLARATION % { 'id': id })
+    native_lines.append((id, NATIVE_DECLARATION % { 'id': id }))
+
+  # Sorted by id for findNative(), plain string order matches strcmp for ascii names
+  native_lines = [line for (id, line) in sorted(native_lines)]
   
   # Build delay support functions
   get_index_cases = [ ]
@@ -351,6 +375,7 @@ def JS2C(source, target):
     'delay_count': len(delay_ids),
     'source_lines': "\n".join(source_lines),
     'native_lines': "\n".join(native_lines),
+    'native_count': len(native_lines),
     'get_index_cases': "".join(get_index_cases),
     'get_script_source_cases': "".join(get_script_source_cases),
     'get_script_name_cases': "".join(get_script_name_cases)
@@ -25,5 +25,6 @@ python ../tools/js2c.py     \
   ../lib/fbo.js             \
   ../lib/vbo.js             \
   ../lib/vao.js             \
+  ../lib/atlas.js           \
   ../lib/math.js            \
   ../lib/default_main.js    \
\ No newline at end of file